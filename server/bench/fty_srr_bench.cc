@@ -0,0 +1,274 @@
+/*  =========================================================================
+    fty_srr_bench - End to end save/restore benchmark
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+ * Starts a malamute broker, one simulated agent per srr queue and an
+ * etn-licensing stand-in, then drives list/save/restore through SrrManager
+ * the same way fty-srr-cmd does, and reports timings, bus traffic and
+ * peak memory usage.
+ */
+
+#include "dto/request.h"
+#include "dto/response.h"
+#include "fty-srr.h"
+#include "fty_srr_groups.h"
+#include "fty_srr_manager.h"
+#include "helpers/clock.h"
+#include "helpers/trace.h"
+#include "simulated_agent.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <fty/command-line.h>
+#include <fty_common.h>
+#include <fty_common_dto.h>
+#include <fty_common_messagebus.h>
+#include <fty_log.h>
+#include <iostream>
+#include <malamute.h>
+#include <memory>
+#include <pack/serialization.h>
+#include <sys/resource.h>
+#include <vector>
+
+#define BENCH_CLIENT_NAME "fty-srr-bench"
+#define BENCH_TIMEOUT_SEC 3600
+
+using namespace srr::bench;
+
+struct PhaseResult
+{
+    std::string m_name;
+    double      m_seconds        = 0;
+    double      m_logicalSeconds = 0; // wall time plus simulated delays
+    std::string m_status;
+    uint64_t    m_bytes = 0;
+};
+
+static dto::UserData sendUiRequest(
+    messagebus::MessageBus& bus, const std::string& action, const dto::UserData& userData)
+{
+    messagebus::Message msg;
+    msg.userData() = userData;
+    msg.metaData().emplace(messagebus::Message::SUBJECT, action);
+    msg.metaData().emplace(messagebus::Message::FROM, BENCH_CLIENT_NAME);
+    msg.metaData().emplace(messagebus::Message::TO, std::string(AGENT_NAME) + "-ui");
+    msg.metaData().emplace(messagebus::Message::CORRELATION_ID, messagebus::generateUuid());
+
+    return bus.request(std::string(SRR_MSG_QUEUE_NAME) + ".UI", msg, BENCH_TIMEOUT_SEC).userData();
+}
+
+static long peakRssKb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+template <typename Function>
+static PhaseResult runPhase(
+    const std::string& name, BusCounters& counters, srr::SimulatedClock& simulatedClock, Function&& function)
+{
+    PhaseResult result;
+    result.m_name = name;
+
+    const uint64_t bytesBefore     = counters.m_bytesReceived + counters.m_bytesSent;
+    const auto     simulatedBefore = simulatedClock.elapsed();
+    const auto     start           = std::chrono::steady_clock::now();
+
+    result.m_status = function();
+
+    result.m_seconds        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.m_logicalSeconds = result.m_seconds +
+                              std::chrono::duration<double>(simulatedClock.elapsed() - simulatedBefore).count();
+    result.m_bytes = counters.m_bytesReceived + counters.m_bytesSent - bytesBefore;
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    std::string endpoint   = "ipc://@/fty-srr-bench";
+    std::string latency    = "0";
+    std::string payload    = "1024";
+    std::string failure    = "0";
+    std::string iterations = "1";
+    std::string poolSize   = BUS_POOL_SIZE_DEFAULT;
+    std::string passphrase = "Bench-passphrase-2020";
+    std::string traceFile  = "";
+    bool        noRestore  = false;
+    bool        simulated  = false;
+    bool        help       = false;
+
+    // clang-format off
+    fty::CommandLine cmd("### - SRR end to end benchmark\n      Usage: fty-srr-bench [options]", {
+        {"--help|-h", help, "Show this help"},
+        {"--endpoint|-e", endpoint, "Malamute endpoint of the benchmark broker"},
+        {"--latency|-l", latency, "Latency of the simulated agents, in msec"},
+        {"--payload|-s", payload, "Size of the data of each saved feature, in bytes"},
+        {"--failure|-f", failure, "Failure rate of the simulated agents, between 0 and 1"},
+        {"--iterations|-i", iterations, "Number of save/restore cycles"},
+        {"--pool|-P", poolSize, "Number of back end bus clients"},
+        {"--passphrase|-p", passphrase, "Passphrase used to save and restore"},
+        {"--no-restore|-n", noRestore, "Skip the restore phase"},
+        {"--simulated-clock|-c", simulated, "Do not wait for the fixed delays, report them as logical time"},
+        {"--trace|-t", traceFile, "Write the Chrome trace of the whole run in this file"}
+    });
+    // clang-format on
+
+    if (auto res = cmd.parse(argc, argv); !res) {
+        std::cerr << res.error() << std::endl;
+        std::cout << cmd.help() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (help) {
+        std::cout << cmd.help() << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    ftylog_setInstance(BENCH_CLIENT_NAME, "");
+    ftylog_setLogLevelError(ftylog_getInstance());
+
+    AgentBehaviour behaviour;
+    behaviour.m_latency     = std::chrono::milliseconds(std::stoi(latency));
+    behaviour.m_payloadSize = std::stoul(payload);
+    behaviour.m_failureRate = std::stod(failure);
+
+    // broker
+    zactor_t* broker = zactor_new(mlm_server, const_cast<char*>("Malamute"));
+    zstr_sendx(broker, "BIND", endpoint.c_str(), nullptr);
+
+    BusCounters                                  counters;
+    std::vector<std::unique_ptr<SimulatedAgent>> agents;
+    for (const auto& agent : srr::g_agentToQueue) {
+        agents.emplace_back(new SimulatedAgent(endpoint, agent.first, agent.second, behaviour, counters));
+    }
+    SimulatedLicensing licensing(endpoint);
+
+    std::map<std::string, std::string> parameters;
+    parameters[AGENT_NAME_KEY]         = AGENT_NAME;
+    parameters[ENDPOINT_KEY]           = endpoint;
+    parameters[SRR_QUEUE_NAME_KEY]     = SRR_MSG_QUEUE_NAME;
+    parameters[SRR_VERSION_KEY]        = ACTIVE_VERSION;
+    parameters[REQUEST_TIMEOUT_KEY]    = "600000";
+    parameters[ENABLE_REBOOT_KEY]      = "false";
+    parameters[LICENSE_CACHE_TTL_KEY]  = LICENSE_CACHE_TTL_DEFAULT;
+    parameters[BUS_POOL_SIZE_KEY]      = poolSize;
+    parameters[SAVE_TIMEOUT_KEY]       = SAVE_TIMEOUT_DEFAULT;
+    parameters[PREFLIGHT_KEY]          = PREFLIGHT_DEFAULT;
+    parameters[PREFLIGHT_TIMEOUT_KEY]  = PREFLIGHT_TIMEOUT_DEFAULT;
+    parameters[TRACE_KEY]              = traceFile.empty() ? TRACE_DEFAULT : "true";
+    parameters[TRACE_DIR_KEY]          = TRACE_DIR_DEFAULT;
+    parameters[METRICS_FILE_KEY]       = METRICS_FILE_DEFAULT;
+    parameters[METRICS_PERIOD_KEY]     = METRICS_PERIOD_DEFAULT;
+    parameters[SNAPSHOT_DIR_KEY]       = SNAPSHOT_DIR_DEFAULT;
+    parameters[SNAPSHOT_RETENTION_KEY] = SNAPSHOT_RETENTION_DEFAULT;
+    parameters[SAVE_CACHE_STREAM_KEY]  = SAVE_CACHE_STREAM_DEFAULT;
+    parameters[SAVE_CACHE_TTL_KEY]     = SAVE_CACHE_TTL_DEFAULT;
+
+    srr::SimulatedClock      simulatedClock;
+    srr::Clock&              clock = simulated ? static_cast<srr::Clock&>(simulatedClock) : srr::Clock::system();
+    std::vector<PhaseResult> results;
+    {
+        srr::SrrManager srrManager(parameters, clock);
+
+        std::unique_ptr<messagebus::MessageBus> client(messagebus::MlmMessageBus(endpoint, BENCH_CLIENT_NAME));
+        client->connect();
+
+        std::vector<std::string> groupList;
+        results.push_back(runPhase("list", counters, simulatedClock, [&]() {
+            dto::UserData resp = sendUiRequest(*client, "list", {});
+
+            srr::SrrListResponse        listResp;
+            cxxtools::SerializationInfo si = dto::srr::deserializeJson(resp.front());
+            si >>= listResp;
+            for (const auto& group : listResp.m_groups) {
+                groupList.push_back(group.m_group_id);
+            }
+            return std::string("SUCCESS");
+        }));
+
+        for (int i = 0; i < std::stoi(iterations); i++) {
+            std::string savePayload;
+            results.push_back(runPhase("save", counters, simulatedClock, [&]() {
+                srr::SrrSaveRequest req;
+                req.m_passphrase.setValue(passphrase);
+                req.m_group_list.setValue(groupList);
+
+                auto reqJson = pack::json::serialize(req, pack::Option::WithDefaults);
+                if (!reqJson) {
+                    throw std::runtime_error(reqJson.error());
+                }
+
+                dto::UserData resp = sendUiRequest(*client, "save", {*reqJson});
+                savePayload        = resp.back();
+                return resp.front();
+            }));
+
+            if (noRestore) {
+                continue;
+            }
+
+            results.push_back(runPhase("restore", counters, simulatedClock, [&]() {
+                srr::SrrSaveResponse        saveResp;
+                cxxtools::SerializationInfo saveSi = dto::srr::deserializeJson(savePayload);
+                saveSi >>= saveResp;
+
+                auto data    = std::make_shared<srr::SrrRestoreRequestDataV2>();
+                data->m_data = saveResp.m_data;
+
+                srr::SrrRestoreRequest req;
+                req.m_version    = saveResp.m_version;
+                req.m_passphrase = passphrase;
+                req.m_checksum   = saveResp.m_checksum;
+                req.m_data_ptr   = data;
+
+                cxxtools::SerializationInfo reqSi;
+                reqSi <<= req;
+
+                dto::UserData resp = sendUiRequest(*client, "restore", {dto::srr::serializeJson(reqSi, false)});
+                return resp.front();
+            }));
+        }
+    }
+
+    agents.clear();
+    zactor_destroy(&broker);
+
+    if (!traceFile.empty()) {
+        std::ofstream file(traceFile);
+        file << srr::Tracer::instance().exportChromeTrace();
+    }
+
+    double total = 0;
+    std::printf("%-10s %-16s %12s %12s %14s\n", "phase", "status", "time (s)", "logical (s)", "bus bytes");
+    for (const auto& result : results) {
+        std::printf("%-10s %-16s %12.3f %12.3f %14llu\n", result.m_name.c_str(), result.m_status.c_str(),
+            result.m_seconds, result.m_logicalSeconds, static_cast<unsigned long long>(result.m_bytes));
+        total += result.m_seconds;
+    }
+    std::printf("total: %.3f s, %llu agent requests, %llu bytes received by agents, %llu bytes sent by agents, "
+                "peak RSS %ld kB\n",
+        total, static_cast<unsigned long long>(counters.m_requests.load()),
+        static_cast<unsigned long long>(counters.m_bytesReceived.load()),
+        static_cast<unsigned long long>(counters.m_bytesSent.load()), peakRssKb());
+
+    return EXIT_SUCCESS;
+}
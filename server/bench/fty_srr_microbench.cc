@@ -0,0 +1,307 @@
+/*  =========================================================================
+    fty_srr_microbench - DTO and data integrity microbenchmarks
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+ * Measures the CPU bound paths of a save/restore on synthetic data shaped
+ * like a real save: every known group with all its features, the feature
+ * data being Json objects as sent by the agents. Each result is printed as
+ * one Json object per line so that runs of different builds can be diffed.
+ */
+
+#include "dto/request.h"
+#include "dto/response.h"
+#include "fty_srr_groups.h"
+#include "helpers/data_integrity.h"
+#include "legacy_request.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fty/command-line.h>
+#include <fty/string-utils.h>
+#include <fty_common_dto.h>
+#include <functional>
+#include <iostream>
+#include <pack/serialization.h>
+#include <random>
+
+using namespace srr;
+using namespace srr::bench;
+
+#define RECORD_SIZE 256
+
+// Build the Json data of one feature, made of records of about RECORD_SIZE bytes
+static std::string buildFeatureData(const std::string& featureName, size_t size)
+{
+    std::string data = "{\"version\":\"1.0\",\"feature\":\"" + featureName + "\",\"items\":[";
+
+    const std::string value(RECORD_SIZE - 48, 'x');
+    for (size_t i = 0; data.size() < size; i++) {
+        if (i != 0) {
+            data += ",";
+        }
+        data += "{\"id\":\"item-" + std::to_string(i) + "\",\"enabled\":true,\"value\":\"" + value + "\"}";
+    }
+    data += "]}";
+
+    return data;
+}
+
+// Build one group per known group, spreading totalSize over all the features
+static std::vector<Group> buildGroups(size_t totalSize)
+{
+    size_t featureCount = 0;
+    for (const auto& group : g_srrGroupMap) {
+        featureCount += group.second.m_fp.size();
+    }
+    const size_t featureSize = std::max<size_t>(totalSize / std::max<size_t>(featureCount, 1), 1);
+
+    std::vector<Group> groups;
+    for (const auto& srrGroup : g_srrGroupMap) {
+        Group group;
+        group.m_group_id   = srrGroup.second.m_id;
+        group.m_group_name = srrGroup.second.m_name;
+
+        for (const auto& fp : srrGroup.second.m_fp) {
+            SrrFeature feature;
+            feature.m_feature_name = fp.m_feature;
+            feature.m_feature_and_status.mutable_status()->set_status(dto::srr::Status::SUCCESS);
+            feature.m_feature_and_status.mutable_feature()->set_version("1.0");
+            feature.m_feature_and_status.mutable_feature()->set_data(buildFeatureData(fp.m_feature, featureSize));
+            group.m_features.push_back(feature);
+        }
+        evalDataIntegrity(group);
+        groups.push_back(group);
+    }
+
+    return groups;
+}
+
+static size_t parseSize(const std::string& str)
+{
+    size_t      pos  = 0;
+    size_t      size = std::stoul(str, &pos);
+    std::string unit = str.substr(pos);
+
+    if (unit == "K" || unit == "KB") {
+        size *= 1024;
+    } else if (unit == "M" || unit == "MB") {
+        size *= 1024 * 1024;
+    } else if (unit == "G" || unit == "GB") {
+        size *= 1024 * 1024 * 1024;
+    } else if (!unit.empty()) {
+        throw std::runtime_error("Invalid size " + str);
+    }
+    return size;
+}
+
+// Run function until minTime is elapsed (at least once) and print the result
+static void runBenchmark(const std::string& name, size_t dataSize, size_t bytes, std::chrono::milliseconds minTime,
+    const std::function<void()>& setup, const std::function<void()>& function)
+{
+    std::chrono::nanoseconds elapsed(0);
+    unsigned long            iterations = 0;
+
+    do {
+        if (setup) {
+            setup();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        elapsed += std::chrono::steady_clock::now() - start;
+        iterations++;
+    } while (elapsed < minTime);
+
+    const double nsPerOp  = double(elapsed.count()) / double(iterations);
+    const double mbPerSec = nsPerOp > 0 ? (double(bytes) / (1024 * 1024)) / (nsPerOp / 1e9) : 0;
+
+    std::printf("{\"benchmark\":\"%s\",\"data_size\":%zu,\"bytes\":%zu,\"iterations\":%lu,\"ns_per_op\":%.0f,"
+                "\"mb_per_s\":%.2f}\n",
+        name.c_str(), dataSize, bytes, iterations, nsPerOp, mbPerSec);
+    std::fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+    std::string sizes   = "1K,64K,1M,16M,200M";
+    std::string filter  = "";
+    std::string minTime = "500";
+    bool        help    = false;
+
+    // clang-format off
+    fty::CommandLine cmd("### - SRR DTO and data integrity microbenchmarks\n      Usage: fty-srr-microbench [options]", {
+        {"--help|-h", help, "Show this help"},
+        {"--sizes|-s", sizes, "Comma separated list of total save sizes, split over the features (K, M, G suffixes)"},
+        {"--filter|-f", filter, "Run only the benchmarks whose name contains this string"},
+        {"--min-time|-t", minTime, "Minimum time spent on each benchmark, in msec"}
+    });
+    // clang-format on
+
+    if (auto res = cmd.parse(argc, argv); !res) {
+        std::cerr << res.error() << std::endl;
+        std::cout << cmd.help() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (help) {
+        std::cout << cmd.help() << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    const std::chrono::milliseconds minDuration(std::stoi(minTime));
+
+    auto bench = [&](const std::string& name, size_t dataSize, size_t bytes, const std::function<void()>& setup,
+                     const std::function<void()>& function) {
+        if (filter.empty() || name.find(filter) != std::string::npos) {
+            runBenchmark(name, dataSize, bytes, minDuration, setup, function);
+        }
+    };
+
+    // delta save request of all the groups, the request size only depends on the number of features
+    {
+        SrrSaveRequest saveReq;
+        saveReq.m_passphrase.setValue("passphrase");
+        saveReq.m_sessionToken.setValue("session-token");
+        saveReq.m_base_snapshot_id.setValue("20200101-000000");
+
+        std::vector<std::string> groupList;
+        for (const auto& group : g_srrGroupMap) {
+            groupList.push_back(group.first);
+        }
+        saveReq.m_group_list.setValue(groupList);
+        saveReq.m_base_features.setValue(evalFeatureHashes(buildGroups(1024)));
+
+        const std::string json = legacySaveRequestJson(saveReq);
+
+        bench("save_request_serialize_cxxtools", json.size(), json.size(), nullptr, [&]() {
+            legacySaveRequestJson(saveReq);
+        });
+
+        bench("save_request_serialize_pack", json.size(), json.size(), nullptr, [&]() {
+            pack::json::serialize(saveReq, pack::Option::WithDefaults);
+        });
+
+        bench("save_request_parse_cxxtools", json.size(), json.size(), nullptr, [&]() {
+            SrrSaveRequest req;
+            legacyParseSaveRequest(json, req);
+        });
+
+        bench("save_request_parse_pack", json.size(), json.size(), nullptr, [&]() {
+            SrrSaveRequest req;
+            pack::json::deserialize(json, req);
+        });
+    }
+
+    for (const auto& sizeStr : fty::split(sizes, ",")) {
+        const size_t dataSize = parseSize(sizeStr);
+
+        std::vector<Group> groups = buildGroups(dataSize);
+
+        SrrSaveResponse saveResp;
+        saveResp.m_status  = dto::srr::statusToString(dto::srr::Status::SUCCESS);
+        saveResp.m_version = ACTIVE_VERSION;
+        saveResp.m_data    = groups;
+
+        cxxtools::SerializationInfo saveSi;
+        saveSi <<= saveResp;
+        const std::string saveJson = dto::srr::serializeJson(saveSi, false);
+
+        auto restoreData    = std::make_shared<SrrRestoreRequestDataV2>();
+        restoreData->m_data = groups;
+
+        SrrRestoreRequest restoreReq;
+        restoreReq.m_version  = ACTIVE_VERSION;
+        restoreReq.m_data_ptr = restoreData;
+
+        cxxtools::SerializationInfo restoreSi;
+        restoreSi <<= restoreReq;
+        const std::string restoreJson = dto::srr::serializeJson(restoreSi, false);
+
+        const size_t bytes = saveJson.size();
+
+        bench("save_response_serialize", dataSize, bytes, nullptr, [&]() {
+            cxxtools::SerializationInfo si;
+            si <<= saveResp;
+            dto::srr::serializeJson(si, false);
+        });
+
+        bench("save_response_parse", dataSize, bytes, nullptr, [&]() {
+            SrrSaveResponse             resp;
+            cxxtools::SerializationInfo si = dto::srr::deserializeJson(saveJson);
+            si >>= resp;
+        });
+
+        bench("restore_request_parse", dataSize, restoreJson.size(), nullptr, [&]() {
+            SrrRestoreRequest           req;
+            cxxtools::SerializationInfo si = dto::srr::deserializeJson(restoreJson);
+            si >>= req;
+        });
+
+        bench("restore_request_serialize", dataSize, restoreJson.size(), nullptr, [&]() {
+            cxxtools::SerializationInfo si;
+            si <<= restoreReq;
+            dto::srr::serializeJson(si, false);
+        });
+
+        bench("sha256", dataSize, bytes, nullptr, [&]() {
+            evalSha256(saveJson);
+        });
+
+        std::vector<Group> workGroups;
+        std::mt19937       rng(42);
+
+        auto shuffle = [&]() {
+            workGroups = groups;
+            std::shuffle(workGroups.begin(), workGroups.end(), rng);
+            for (auto& group : workGroups) {
+                std::shuffle(group.m_features.begin(), group.m_features.end(), rng);
+            }
+        };
+
+        bench("eval_data_integrity", dataSize, bytes, shuffle, [&]() {
+            for (auto& group : workGroups) {
+                evalDataIntegrity(group);
+            }
+        });
+
+        bench("check_data_integrity", dataSize, bytes, nullptr, [&]() {
+            for (const auto& group : groups) {
+                checkDataIntegrity(group);
+            }
+        });
+
+        // same sorts as done by the worker before a restore
+        bench("priority_sort", dataSize, bytes, shuffle, [&]() {
+            std::sort(workGroups.begin(), workGroups.end(), [&](const Group& l, const Group& r) {
+                return g_srrGroupMap.at(l.m_group_id).m_restoreOrder < g_srrGroupMap.at(r.m_group_id).m_restoreOrder;
+            });
+            for (auto& group : workGroups) {
+                std::sort(group.m_features.begin(), group.m_features.end(), [&](SrrFeature l, SrrFeature r) {
+                    return getPriority(l.m_feature_name) < getPriority(r.m_feature_name);
+                });
+            }
+        });
+
+        bench("get_srr_features", dataSize, bytes, nullptr, [&]() {
+            restoreData->getSrrFeatures();
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
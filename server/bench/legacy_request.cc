@@ -0,0 +1,78 @@
+/*  =========================================================================
+    legacy_request - Former cxxtools encoding of the srr requests
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "legacy_request.h"
+#include <cxxtools/serializationinfo.h>
+#include <fty_common_dto.h>
+#include <map>
+#include <vector>
+
+namespace srr::bench {
+
+std::string legacySaveRequestJson(const SrrSaveRequest& req)
+{
+    cxxtools::SerializationInfo si;
+    si.addMember(SI_PASSPHRASE) <<= req.m_passphrase.value();
+    si.addMember(SI_GROUP_LIST) <<= req.m_group_list.value();
+    si.addMember(dto::srr::SESSION_TOKEN) <<= req.m_sessionToken.value();
+
+    if (!req.m_base_snapshot_id.value().empty()) {
+        si.addMember(SI_BASE_SNAPSHOT_ID) <<= req.m_base_snapshot_id.value();
+    }
+    if (!req.m_base_features.value().empty()) {
+        cxxtools::SerializationInfo& baseSi = si.addMember(SI_BASE_FEATURES);
+        baseSi.setCategory(cxxtools::SerializationInfo::Category::Object);
+        for (const auto& feature : req.m_base_features.value()) {
+            baseSi.addMember(feature.first) <<= feature.second;
+        }
+    }
+
+    return dto::srr::serializeJson(si, false);
+}
+
+void legacyParseSaveRequest(const std::string& json, SrrSaveRequest& req)
+{
+    cxxtools::SerializationInfo si = dto::srr::deserializeJson(json);
+
+    std::string              str;
+    std::vector<std::string> list;
+
+    si.getMember(SI_PASSPHRASE) >>= str;
+    req.m_passphrase.setValue(str);
+    si.getMember(SI_GROUP_LIST) >>= list;
+    req.m_group_list.setValue(list);
+    si.getMember(dto::srr::SESSION_TOKEN) >>= str;
+    req.m_sessionToken.setValue(str);
+
+    if (si.findMember(SI_BASE_SNAPSHOT_ID) != nullptr) {
+        si.getMember(SI_BASE_SNAPSHOT_ID) >>= str;
+        req.m_base_snapshot_id.setValue(str);
+    }
+    if (const cxxtools::SerializationInfo* baseSi = si.findMember(SI_BASE_FEATURES)) {
+        std::map<std::string, std::string> features;
+        for (const auto& feature : *baseSi) {
+            feature >>= features[feature.name()];
+        }
+        req.m_base_features.setValue(features);
+    }
+}
+
+} // namespace srr::bench
@@ -0,0 +1,38 @@
+/*  =========================================================================
+    legacy_request - Former cxxtools encoding of the srr requests
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include "dto/request.h"
+#include <string>
+
+namespace srr::bench {
+
+/**
+ * Former cxxtools encoding of the save request, reference of the wire format
+ * of the fty-pack encoding, and baseline of its benchmarks
+ */
+std::string legacySaveRequestJson(const SrrSaveRequest& req);
+
+// former cxxtools decoding of the save request
+void legacyParseSaveRequest(const std::string& json, SrrSaveRequest& req);
+
+} // namespace srr::bench
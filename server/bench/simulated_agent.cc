@@ -0,0 +1,185 @@
+/*  =========================================================================
+    simulated_agent - Fake srr agents for benchmarks
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "simulated_agent.h"
+#include "fty-srr.h"
+#include <fty_common.h>
+#include <fty_common_dto.h>
+#include <numeric>
+
+namespace srr::bench {
+
+static uint64_t userDataSize(const dto::UserData& data)
+{
+    return std::accumulate(data.begin(), data.end(), uint64_t(0), [](uint64_t sum, const std::string& frame) {
+        return sum + frame.size();
+    });
+}
+
+SimulatedAgent::SimulatedAgent(const std::string& endpoint, const std::string& agentName,
+    const std::string& queueName, const AgentBehaviour& behaviour, BusCounters& counters)
+    : m_agentName(agentName)
+    , m_behaviour(behaviour)
+    , m_counters(counters)
+    , m_random(std::hash<std::string>{}(agentName))
+{
+    m_bus = std::unique_ptr<messagebus::MessageBus>(messagebus::MlmMessageBus(endpoint, agentName));
+    m_bus->connect();
+    m_bus->receive(queueName, [this](messagebus::Message msg) {
+        handleRequest(msg);
+    });
+}
+
+void SimulatedAgent::setBehaviour(const AgentBehaviour& behaviour)
+{
+    std::lock_guard<std::mutex> lock(m_behaviourMutex);
+    m_behaviour = behaviour;
+}
+
+bool SimulatedAgent::shouldFail(const AgentBehaviour& behaviour, const std::string& operation)
+{
+    if (behaviour.m_failing.count(operation)) {
+        return true;
+    }
+    std::lock_guard<std::mutex>            lock(m_randomMutex);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    return distribution(m_random) < behaviour.m_failureRate;
+}
+
+void SimulatedAgent::handleRequest(messagebus::Message msg)
+{
+    using namespace dto::srr;
+
+    AgentBehaviour behaviour;
+    {
+        std::lock_guard<std::mutex> lock(m_behaviourMutex);
+        behaviour = m_behaviour;
+    }
+
+    m_counters.m_requests++;
+    m_counters.m_bytesReceived += userDataSize(msg.userData());
+
+    if (behaviour.m_silent) {
+        return;
+    }
+
+    Query query;
+    msg.userData() >> query;
+
+    std::this_thread::sleep_for(behaviour.m_latency);
+
+    Response response;
+    switch (query.parameters_case()) {
+        case Query::ParametersCase::kSave: {
+            auto& features = *(response.mutable_save()->mutable_map_features_data());
+            if (query.save().features().empty()) {
+                m_counters.m_fullSaves++;
+            }
+            for (const auto& featureName : query.save().features()) {
+                FeatureAndStatus& fs = features[featureName];
+                if (featureName == F_PING) {
+                    fs.mutable_status()->set_status(Status::FAILED);
+                    fs.mutable_status()->set_error("Feature " + featureName + " not supported");
+                    continue;
+                }
+                fs.mutable_feature()->set_version("1.0");
+                fs.mutable_feature()->set_data(
+                    "{\"blob\":\"" + std::string(behaviour.m_payloadSize, 'x') + "\"}");
+                fs.mutable_status()->set_status(shouldFail(behaviour, "save") ? Status::FAILED : Status::SUCCESS);
+            }
+            break;
+        }
+        case Query::ParametersCase::kRestore: {
+            bool  failed   = false;
+            auto& statuses = *(response.mutable_restore()->mutable_map_features_status());
+            for (const auto& feature : query.restore().map_features_data()) {
+                const bool fail = shouldFail(behaviour, "restore");
+                statuses[feature.first].set_status(fail ? Status::FAILED : Status::SUCCESS);
+                failed |= fail;
+            }
+            response.mutable_restore()->mutable_status()->set_status(failed ? Status::FAILED : Status::SUCCESS);
+            break;
+        }
+        case Query::ParametersCase::kReset: {
+            auto& statuses = *(response.mutable_reset()->mutable_map_features_status());
+            for (const auto& featureName : query.reset().features()) {
+                statuses[featureName].set_status(shouldFail(behaviour, "reset") ? Status::FAILED : Status::SUCCESS);
+            }
+            break;
+        }
+        default:
+            log_error("%s: unknown query", m_agentName.c_str());
+            return;
+    }
+
+    messagebus::Message reply;
+    reply.userData() << response;
+    reply.metaData().emplace(messagebus::Message::SUBJECT, msg.metaData().at(messagebus::Message::SUBJECT));
+    reply.metaData().emplace(messagebus::Message::FROM, m_agentName);
+    reply.metaData().emplace(messagebus::Message::TO, msg.metaData().at(messagebus::Message::FROM));
+    reply.metaData().emplace(
+        messagebus::Message::CORRELATION_ID, msg.metaData().at(messagebus::Message::CORRELATION_ID));
+
+    m_counters.m_bytesSent += userDataSize(reply.userData());
+    m_bus->sendReply(msg.metaData().at(messagebus::Message::REPLY_TO), reply);
+}
+
+static void licensingActor(zsock_t* pipe, void* args)
+{
+    const char*   endpoint = static_cast<const char*>(args);
+    mlm_client_t* client   = mlm_client_new();
+    mlm_client_connect(client, endpoint, 1000, "etn-licensing");
+
+    zpoller_t* poller = zpoller_new(pipe, mlm_client_msgpipe(client), nullptr);
+    zsock_signal(pipe, 0);
+
+    while (!zsys_interrupted) {
+        void* which = zpoller_wait(poller, -1);
+        if (which == pipe || which == nullptr) {
+            break;
+        }
+
+        zmsg_t* request = mlm_client_recv(client);
+        zmsg_destroy(&request);
+
+        zmsg_t* reply = zmsg_new();
+        zmsg_addstr(reply, "CAPABILITIES");
+        zmsg_addstr(reply, "OK");
+        zmsg_addstr(reply, "1");
+        mlm_client_sendto(client, mlm_client_sender(client), mlm_client_subject(client), nullptr, 1000, &reply);
+    }
+
+    zpoller_destroy(&poller);
+    mlm_client_destroy(&client);
+}
+
+SimulatedLicensing::SimulatedLicensing(const std::string& endpoint)
+{
+    // the actor reads the endpoint before signaling, the string outlives this call
+    m_actor = zactor_new(licensingActor, const_cast<char*>(endpoint.c_str()));
+}
+
+SimulatedLicensing::~SimulatedLicensing()
+{
+    zactor_destroy(&m_actor);
+}
+
+} // namespace srr::bench
@@ -0,0 +1,97 @@
+/*  =========================================================================
+    simulated_agent - Fake srr agents for benchmarks
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fty_common_messagebus.h>
+#include <malamute.h>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace srr::bench {
+
+struct AgentBehaviour
+{
+    std::chrono::milliseconds m_latency{0};       // time spent by the agent on each request
+    size_t                    m_payloadSize = 1024; // size of the data of each saved feature
+    double                    m_failureRate = 0.0;  // probability for a feature to fail
+    std::set<std::string>     m_failing;            // operations (save, restore, reset) always failing
+    bool                      m_silent = false;     // the requests are never answered
+};
+
+/**
+ * Bus traffic seen by the simulated agents
+ */
+struct BusCounters
+{
+    std::atomic<uint64_t> m_requests{0};
+    std::atomic<uint64_t> m_bytesReceived{0};
+    std::atomic<uint64_t> m_bytesSent{0};
+    std::atomic<uint64_t> m_fullSaves{0}; // save queries without feature, saving all the features of an agent
+};
+
+/**
+ * Agent answering save/restore/reset queries on a srr queue
+ */
+class SimulatedAgent
+{
+public:
+    SimulatedAgent(const std::string& endpoint, const std::string& agentName, const std::string& queueName,
+        const AgentBehaviour& behaviour, BusCounters& counters);
+
+    // change the behaviour for the next requests
+    void setBehaviour(const AgentBehaviour& behaviour);
+
+private:
+    std::string                             m_agentName;
+    std::mutex                              m_behaviourMutex;
+    AgentBehaviour                          m_behaviour;
+    BusCounters&                            m_counters;
+    std::unique_ptr<messagebus::MessageBus> m_bus;
+
+    std::mutex   m_randomMutex;
+    std::mt19937 m_random;
+
+    void handleRequest(messagebus::Message msg);
+    bool shouldFail(const AgentBehaviour& behaviour, const std::string& operation);
+};
+
+/**
+ * etn-licensing stand-in, always granting the configurability capability
+ */
+class SimulatedLicensing
+{
+public:
+    explicit SimulatedLicensing(const std::string& endpoint);
+    ~SimulatedLicensing();
+
+private:
+    zactor_t* m_actor;
+};
+
+} // namespace srr::bench
@@ -20,6 +20,8 @@
  */
 
 #include "dto/common.h"
+#include <map>
+#include <utility>
 
 namespace srr {
 void operator<<=(cxxtools::SerializationInfo& si, const dto::srr::FeatureAndStatus& fs)
@@ -28,7 +30,7 @@ void operator<<=(cxxtools::SerializationInfo& si, const dto::srr::FeatureAndStat
     si.addMember(SI_STATUS) <<= dto::srr::statusToString(fs.status().status());
     si.addMember(SI_ERROR) <<= fs.status().error();
 
-    dto::srr::Feature            feature = fs.feature();
+    const dto::srr::Feature&     feature = fs.feature();
     cxxtools::SerializationInfo& data    = si.addMember(SI_DATA);
     try {
         // try to unserialize the data if they are on Json format
@@ -72,12 +74,16 @@ void operator>>=(const cxxtools::SerializationInfo& si, dto::srr::FeatureAndStat
         data = dto::srr::serializeJson(dataSi);
     }
 
-    fs.mutable_feature()->set_data(data);
+    fs.mutable_feature()->set_data(std::move(data));
 }
 
 void operator<<=(cxxtools::SerializationInfo& si, const SrrFeature& f)
 {
-    si.addMember(f.m_feature_name) <<= f.m_feature_and_status;
+    cxxtools::SerializationInfo& featureSi = si.addMember(f.m_feature_name);
+    featureSi <<= f.m_feature_and_status;
+    if (!f.m_ref.empty()) {
+        featureSi.addMember(SI_REF) <<= f.m_ref;
+    }
 }
 
 void operator>>=(const cxxtools::SerializationInfo& si, SrrFeature& f)
@@ -86,6 +92,9 @@ void operator>>=(const cxxtools::SerializationInfo& si, SrrFeature& f)
 
     f.m_feature_name = tmpSi.name();
     tmpSi >>= f.m_feature_and_status;
+    if (tmpSi.findMember(SI_REF) != nullptr) {
+        tmpSi.getMember(SI_REF) >>= f.m_ref;
+    }
 }
 
 void operator<<=(cxxtools::SerializationInfo& si, const FeatureInfo& resp)
@@ -146,4 +155,52 @@ void operator>>=(const cxxtools::SerializationInfo& si, RestoreStatus& resp)
     si.getMember(SI_ERROR) >>= resp.m_error;
 }
 
+Timings& Timings::operator+=(const Timings& other)
+{
+    m_save_ms += other.m_save_ms;
+    m_backup_ms += other.m_backup_ms;
+    m_reset_ms += other.m_reset_ms;
+    m_restore_ms += other.m_restore_ms;
+    m_settle_ms += other.m_settle_ms;
+    m_rollback_ms += other.m_rollback_ms;
+    m_payload_bytes += other.m_payload_bytes;
+
+    return *this;
+}
+
+void operator<<=(cxxtools::SerializationInfo& si, const Timings& timings)
+{
+    si.addMember(SI_NAME) <<= timings.m_name;
+    si.addMember(SI_SAVE_MS) <<= timings.m_save_ms;
+    si.addMember(SI_BACKUP_MS) <<= timings.m_backup_ms;
+    si.addMember(SI_RESET_MS) <<= timings.m_reset_ms;
+    si.addMember(SI_RESTORE_MS) <<= timings.m_restore_ms;
+    si.addMember(SI_SETTLE_MS) <<= timings.m_settle_ms;
+    si.addMember(SI_ROLLBACK_MS) <<= timings.m_rollback_ms;
+    si.addMember(SI_PAYLOAD_BYTES) <<= timings.m_payload_bytes;
+    if (!timings.m_features.empty()) {
+        si.addMember(SI_FEATURES) <<= timings.m_features;
+    }
+}
+
+void operator>>=(const cxxtools::SerializationInfo& si, Timings& timings)
+{
+    si.getMember(SI_NAME) >>= timings.m_name;
+
+    // all the timings are optional
+    const std::map<const char*, uint64_t*> fields = {{SI_SAVE_MS, &timings.m_save_ms},
+        {SI_BACKUP_MS, &timings.m_backup_ms}, {SI_RESET_MS, &timings.m_reset_ms},
+        {SI_RESTORE_MS, &timings.m_restore_ms}, {SI_SETTLE_MS, &timings.m_settle_ms},
+        {SI_ROLLBACK_MS, &timings.m_rollback_ms}, {SI_PAYLOAD_BYTES, &timings.m_payload_bytes}};
+
+    for (const auto& field : fields) {
+        if (si.findMember(field.first) != nullptr) {
+            si.getMember(field.first) >>= *field.second;
+        }
+    }
+    if (si.findMember(SI_FEATURES) != nullptr) {
+        si.getMember(SI_FEATURES) >>= timings.m_features;
+    }
+}
+
 } // namespace srr
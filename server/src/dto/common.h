@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cxxtools/serializationinfo.h>
 #include <fty_common_dto.h>
 #include <string>
@@ -45,6 +46,24 @@ static constexpr const char* SI_GROUP_ID       = "group_id";
 static constexpr const char* SI_GROUP_NAME     = "group_name";
 static constexpr const char* SI_DATA_INTEGRITY = "data_integrity";
 
+// si timing fields
+static constexpr const char* SI_TIMINGS       = "timings";
+static constexpr const char* SI_SAVE_MS       = "save_ms";
+static constexpr const char* SI_BACKUP_MS     = "backup_ms";
+static constexpr const char* SI_RESET_MS      = "reset_ms";
+static constexpr const char* SI_RESTORE_MS    = "restore_ms";
+static constexpr const char* SI_SETTLE_MS     = "settle_ms";
+static constexpr const char* SI_ROLLBACK_MS   = "rollback_ms";
+static constexpr const char* SI_PAYLOAD_BYTES = "payload_bytes";
+
+// si snapshot reference
+static constexpr const char* SI_SNAPSHOT_ID = "snapshot_id";
+
+// si delta save fields
+static constexpr const char* SI_REF              = "ref";
+static constexpr const char* SI_BASE_SNAPSHOT_ID = "base_snapshot_id";
+static constexpr const char* SI_BASE_FEATURES    = "base_features";
+
 void operator<<=(cxxtools::SerializationInfo& si, const dto::srr::FeatureAndStatus& fs);
 void operator>>=(const cxxtools::SerializationInfo& si, dto::srr::FeatureAndStatus& fs);
 
@@ -54,6 +73,9 @@ public:
     SrrFeature(){};
     std::string                m_feature_name;
     dto::srr::FeatureAndStatus m_feature_and_status;
+
+    // optional, hash of the unchanged feature of the base save (delta save), the data being omitted
+    std::string m_ref;
 };
 
 void operator<<=(cxxtools::SerializationInfo& si, const SrrFeature& f);
@@ -112,4 +134,28 @@ public:
 void operator<<=(cxxtools::SerializationInfo& si, const RestoreStatus& resp);
 void operator>>=(const cxxtools::SerializationInfo& si, RestoreStatus& resp);
 
+// time spent on each step of a feature or a group (with the details of its features)
+class Timings
+{
+public:
+    Timings(){};
+    std::string m_name;
+
+    uint64_t m_save_ms       = 0;
+    uint64_t m_backup_ms     = 0;
+    uint64_t m_reset_ms      = 0;
+    uint64_t m_restore_ms    = 0;
+    uint64_t m_settle_ms     = 0;
+    uint64_t m_rollback_ms   = 0;
+    uint64_t m_payload_bytes = 0;
+
+    std::vector<Timings> m_features;
+
+    // add the durations and payload of other (features are not merged)
+    Timings& operator+=(const Timings& other);
+};
+
+void operator<<=(cxxtools::SerializationInfo& si, const Timings& timings);
+void operator>>=(const cxxtools::SerializationInfo& si, Timings& timings);
+
 } // namespace srr
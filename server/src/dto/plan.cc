@@ -0,0 +1,79 @@
+/*  =========================================================================
+    fty_srr_server - Fty srr server
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+ */
+
+#include "dto/plan.h"
+
+namespace srr {
+void operator<<=(cxxtools::SerializationInfo& si, const PlanStep& step)
+{
+    si.addMember(SI_AGENT) <<= step.m_agent;
+    si.addMember(SI_FEATURES) <<= step.m_features;
+    si.addMember(SI_ESTIMATED_MS) <<= step.m_estimated_ms;
+}
+
+void operator>>=(const cxxtools::SerializationInfo& si, PlanStep& step)
+{
+    si.getMember(SI_AGENT) >>= step.m_agent;
+    si.getMember(SI_FEATURES) >>= step.m_features;
+    si.getMember(SI_ESTIMATED_MS) >>= step.m_estimated_ms;
+}
+
+void operator<<=(cxxtools::SerializationInfo& si, const GroupPlan& group)
+{
+    si.addMember(SI_GROUP_ID) <<= group.m_group_id;
+    if (!group.m_error.empty()) {
+        si.addMember(SI_ERROR) <<= group.m_error;
+    }
+    si.addMember(SI_BACKUP) <<= group.m_backup;
+    si.addMember(SI_RESET) <<= group.m_reset;
+    si.addMember(SI_RESTORE) <<= group.m_restore;
+    si.addMember(SI_RELOAD) <<= group.m_reload;
+    si.addMember(SI_ESTIMATED_MS) <<= group.m_estimated_ms;
+}
+
+void operator>>=(const cxxtools::SerializationInfo& si, GroupPlan& group)
+{
+    si.getMember(SI_GROUP_ID) >>= group.m_group_id;
+    if (si.findMember(SI_ERROR) != nullptr) {
+        si.getMember(SI_ERROR) >>= group.m_error;
+    }
+    si.getMember(SI_BACKUP) >>= group.m_backup;
+    si.getMember(SI_RESET) >>= group.m_reset;
+    si.getMember(SI_RESTORE) >>= group.m_restore;
+    si.getMember(SI_RELOAD) >>= group.m_reload;
+    si.getMember(SI_ESTIMATED_MS) >>= group.m_estimated_ms;
+}
+
+void operator<<=(cxxtools::SerializationInfo& si, const RestorePlan& plan)
+{
+    si.addMember(SI_GROUPS) <<= plan.m_groups;
+    si.addMember(SI_REBOOT) <<= plan.m_reboot;
+    si.addMember(SI_ESTIMATED_MS) <<= plan.m_estimated_ms;
+}
+
+void operator>>=(const cxxtools::SerializationInfo& si, RestorePlan& plan)
+{
+    si.getMember(SI_GROUPS) >>= plan.m_groups;
+    si.getMember(SI_REBOOT) >>= plan.m_reboot;
+    si.getMember(SI_ESTIMATED_MS) >>= plan.m_estimated_ms;
+}
+
+} // namespace srr
@@ -0,0 +1,90 @@
+/*  =========================================================================
+    fty_srr_server - Fty srr server
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+ */
+
+#pragma once
+
+#include "common.h"
+#include <cstdint>
+#include <cxxtools/serializationinfo.h>
+#include <string>
+#include <vector>
+
+namespace srr {
+// si restore plan fields
+static constexpr const char* SI_PLAN         = "plan";
+static constexpr const char* SI_AGENT        = "agent";
+static constexpr const char* SI_ESTIMATED_MS = "estimated_ms";
+static constexpr const char* SI_BACKUP       = "backup";
+static constexpr const char* SI_RESET        = "reset";
+static constexpr const char* SI_RESTORE      = "restore";
+static constexpr const char* SI_RELOAD       = "reload";
+static constexpr const char* SI_REBOOT       = "reboot";
+
+// one query sent to an agent
+class PlanStep
+{
+public:
+    PlanStep(){};
+
+    std::string              m_agent;
+    std::vector<std::string> m_features;
+    uint64_t                 m_estimated_ms = 0;
+};
+
+void operator<<=(cxxtools::SerializationInfo& si, const PlanStep& step);
+void operator>>=(const cxxtools::SerializationInfo& si, PlanStep& step);
+
+// steps of the restore of a group, in execution order
+class GroupPlan
+{
+public:
+    GroupPlan(){};
+
+    std::string m_group_id;
+    std::string m_error; // if set, the group is skipped
+
+    std::vector<PlanStep> m_backup;  // sequential
+    std::vector<PlanStep> m_reset;   // concurrent
+    std::vector<PlanStep> m_restore; // sequential, each one followed by the settle delay
+
+    std::vector<std::string> m_reload; // restored features requiring a restart
+
+    uint64_t m_estimated_ms = 0;
+};
+
+void operator<<=(cxxtools::SerializationInfo& si, const GroupPlan& group);
+void operator>>=(const cxxtools::SerializationInfo& si, GroupPlan& group);
+
+class RestorePlan
+{
+public:
+    RestorePlan(){};
+
+    std::vector<GroupPlan> m_groups; // in restore order
+    bool                   m_reboot = false;
+
+    uint64_t m_estimated_ms = 0;
+};
+
+void operator<<=(cxxtools::SerializationInfo& si, const RestorePlan& plan);
+void operator>>=(const cxxtools::SerializationInfo& si, RestorePlan& plan);
+
+} // namespace srr
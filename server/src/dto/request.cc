@@ -47,20 +47,6 @@ const std::vector<SrrFeature> SrrRestoreRequestDataV2::getSrrFeatures() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void operator<<=(cxxtools::SerializationInfo& si, const SrrSaveRequest& req)
-{
-    si.addMember(SI_PASSPHRASE) <<= req.m_passphrase;
-    si.addMember(SI_GROUP_LIST) <<= req.m_group_list;
-    si.addMember(SESSION_TOKEN) <<= req.m_sessionToken;
-}
-
-void operator>>=(const cxxtools::SerializationInfo& si, SrrSaveRequest& req)
-{
-    si.getMember(SI_PASSPHRASE) >>= req.m_passphrase;
-    si.getMember(SI_GROUP_LIST) >>= req.m_group_list;
-    si.getMember(SESSION_TOKEN) >>= req.m_sessionToken;
-}
-
 void operator<<=(cxxtools::SerializationInfo& si, const SrrRestoreRequest& req)
 {
     si.addMember(SI_VERSION) <<= req.m_version;
@@ -68,6 +54,28 @@ void operator<<=(cxxtools::SerializationInfo& si, const SrrRestoreRequest& req)
     si.addMember(SI_CHECKSUM) <<= req.m_checksum;
     si.addMember(SESSION_TOKEN) <<= req.m_sessionToken;
 
+    if (!req.m_base_snapshot_id.empty()) {
+        si.addMember(SI_BASE_SNAPSHOT_ID) <<= req.m_base_snapshot_id;
+    }
+
+    if (req.m_dry_run) {
+        si.addMember(SI_DRY_RUN) <<= req.m_dry_run;
+    }
+
+    if (!req.m_include.empty()) {
+        si.addMember(SI_INCLUDE) <<= req.m_include;
+    }
+    if (!req.m_exclude.empty()) {
+        si.addMember(SI_EXCLUDE) <<= req.m_exclude;
+    }
+
+    if (!req.m_snapshot_id.empty()) {
+        si.addMember(SI_SNAPSHOT_ID) <<= req.m_snapshot_id;
+        if (!req.m_data_ptr) {
+            return;
+        }
+    }
+
     if (req.m_version == "1.0") {
         auto dataPtr = std::dynamic_pointer_cast<SrrRestoreRequestDataV1>(req.m_data_ptr);
         if (dataPtr) {
@@ -89,6 +97,38 @@ void operator<<=(cxxtools::SerializationInfo& si, const SrrRestoreRequest& req)
 
 void operator>>=(const cxxtools::SerializationInfo& si, SrrRestoreRequest& req)
 {
+    if (si.findMember(SI_BASE_SNAPSHOT_ID) != nullptr) {
+        si.getMember(SI_BASE_SNAPSHOT_ID) >>= req.m_base_snapshot_id;
+    }
+
+    if (si.findMember(SI_DRY_RUN) != nullptr) {
+        si.getMember(SI_DRY_RUN) >>= req.m_dry_run;
+    }
+
+    if (si.findMember(SI_INCLUDE) != nullptr) {
+        si.getMember(SI_INCLUDE) >>= req.m_include;
+    }
+    if (si.findMember(SI_EXCLUDE) != nullptr) {
+        si.getMember(SI_EXCLUDE) >>= req.m_exclude;
+    }
+
+    if (si.findMember(SI_SNAPSHOT_ID) != nullptr) {
+        si.getMember(SI_SNAPSHOT_ID) >>= req.m_snapshot_id;
+        si.getMember(SI_PASSPHRASE) >>= req.m_passphrase;
+        si.getMember(SESSION_TOKEN) >>= req.m_sessionToken;
+
+        // the data is read from the snapshot
+        if (si.findMember(SI_DATA) == nullptr) {
+            if (si.findMember(SI_VERSION) != nullptr) {
+                si.getMember(SI_VERSION) >>= req.m_version;
+            }
+            if (si.findMember(SI_CHECKSUM) != nullptr) {
+                si.getMember(SI_CHECKSUM) >>= req.m_checksum;
+            }
+            return;
+        }
+    }
+
     si.getMember(SI_VERSION) >>= req.m_version;
     si.getMember(SI_PASSPHRASE) >>= req.m_passphrase;
     si.getMember(SI_CHECKSUM) >>= req.m_checksum;
@@ -23,7 +23,9 @@
 
 #include "common.h"
 #include <cxxtools/serializationinfo.h>
+#include <map>
 #include <memory>
+#include <pack/pack.h>
 #include <string>
 #include <vector>
 
@@ -31,18 +33,27 @@ namespace srr {
 // si save request fields
 static constexpr const char* SI_GROUP_LIST = "group_list";
 
-class SrrSaveRequest
+// si restore request fields
+static constexpr const char* SI_DRY_RUN = "dry_run";
+static constexpr const char* SI_INCLUDE = "include";
+static constexpr const char* SI_EXCLUDE = "exclude";
+
+// The requests without feature data are fty-pack structures, encoded with pack::json without going through a
+// SerializationInfo tree. The field order is the one of the former cxxtools encoding.
+class SrrSaveRequest : public pack::Node
 {
 public:
-    SrrSaveRequest() = default;
+    pack::String     m_passphrase   = FIELD(SI_PASSPHRASE);
+    pack::StringList m_group_list   = FIELD(SI_GROUP_LIST);
+    pack::String     m_sessionToken = FIELD(dto::srr::SESSION_TOKEN);
 
-    std::string              m_passphrase;
-    std::string              m_sessionToken;
-    std::vector<std::string> m_group_list;
-};
+    // optional, delta save: only the features which differ from the base are returned
+    pack::String    m_base_snapshot_id = FIELD(SI_BASE_SNAPSHOT_ID);
+    pack::StringMap m_base_features    = FIELD(SI_BASE_FEATURES); // feature name -> feature hash
 
-void operator<<=(cxxtools::SerializationInfo& si, const SrrSaveRequest& req);
-void operator>>=(const cxxtools::SerializationInfo& si, SrrSaveRequest& req);
+    using pack::Node::Node;
+    META(SrrSaveRequest, m_passphrase, m_group_list, m_sessionToken, m_base_snapshot_id, m_base_features);
+};
 
 class SrrRestoreRequestData
 {
@@ -78,9 +89,33 @@ public:
     std::string              m_sessionToken;
     std::string              m_checksum;
     SrrRestoreRequestDataPtr m_data_ptr;
+
+    // optional, restore a local snapshot instead of the data (version, checksum and data are then optional)
+    std::string m_snapshot_id;
+
+    // optional, local snapshot holding the features referenced by a delta save
+    std::string m_base_snapshot_id;
+
+    // optional, only return the restore plan and its estimated duration
+    bool m_dry_run = false;
+
+    // optional, groups or features to restore (all by default) and to skip
+    std::vector<std::string> m_include;
+    std::vector<std::string> m_exclude;
 };
 
 void operator<<=(cxxtools::SerializationInfo& si, const SrrRestoreRequest& req);
 void operator>>=(const cxxtools::SerializationInfo& si, SrrRestoreRequest& req);
 
+class SrrResetRequest : public pack::Node
+{
+public:
+    pack::String     m_passphrase   = FIELD(SI_PASSPHRASE); // used to save the groups before the reset
+    pack::StringList m_group_list   = FIELD(SI_GROUP_LIST);
+    pack::String     m_sessionToken = FIELD(dto::srr::SESSION_TOKEN);
+
+    using pack::Node::Node;
+    META(SrrResetRequest, m_passphrase, m_group_list, m_sessionToken);
+};
+
 } // namespace srr
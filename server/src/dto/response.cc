@@ -47,6 +47,15 @@ void operator<<=(cxxtools::SerializationInfo& si, const SrrSaveResponse& resp)
     }
     si.addMember(SI_CHECKSUM) <<= resp.m_checksum;
     si.addMember(SI_DATA) <<= resp.m_data;
+    if (!resp.m_timings.empty()) {
+        si.addMember(SI_TIMINGS) <<= resp.m_timings;
+    }
+    if (!resp.m_snapshot_id.empty()) {
+        si.addMember(SI_SNAPSHOT_ID) <<= resp.m_snapshot_id;
+    }
+    if (!resp.m_base_snapshot_id.empty()) {
+        si.addMember(SI_BASE_SNAPSHOT_ID) <<= resp.m_base_snapshot_id;
+    }
 }
 
 void operator>>=(const cxxtools::SerializationInfo& si, SrrSaveResponse& resp)
@@ -58,6 +67,15 @@ void operator>>=(const cxxtools::SerializationInfo& si, SrrSaveResponse& resp)
     }
     si.getMember(SI_CHECKSUM) >>= resp.m_checksum;
     si.getMember(SI_DATA) >>= resp.m_data;
+    if (si.findMember(SI_TIMINGS) != nullptr) {
+        si.getMember(SI_TIMINGS) >>= resp.m_timings;
+    }
+    if (si.findMember(SI_SNAPSHOT_ID) != nullptr) {
+        si.getMember(SI_SNAPSHOT_ID) >>= resp.m_snapshot_id;
+    }
+    if (si.findMember(SI_BASE_SNAPSHOT_ID) != nullptr) {
+        si.getMember(SI_BASE_SNAPSHOT_ID) >>= resp.m_base_snapshot_id;
+    }
 }
 
 void operator<<=(cxxtools::SerializationInfo& si, const SrrRestoreResponse& resp)
@@ -67,6 +85,12 @@ void operator<<=(cxxtools::SerializationInfo& si, const SrrRestoreResponse& resp
         si.addMember(SI_ERROR) <<= resp.m_error;
     }
     si.addMember(SI_STATUS_LIST) <<= resp.m_status_list;
+    if (!resp.m_timings.empty()) {
+        si.addMember(SI_TIMINGS) <<= resp.m_timings;
+    }
+    if (resp.m_plan) {
+        si.addMember(SI_PLAN) <<= *resp.m_plan;
+    }
 }
 
 void operator>>=(const cxxtools::SerializationInfo& si, SrrRestoreResponse& resp)
@@ -76,6 +100,43 @@ void operator>>=(const cxxtools::SerializationInfo& si, SrrRestoreResponse& resp
         si.getMember(SI_ERROR) >>= resp.m_error;
     }
     si.getMember(SI_STATUS_LIST) >>= resp.m_status_list;
+    if (si.findMember(SI_TIMINGS) != nullptr) {
+        si.getMember(SI_TIMINGS) >>= resp.m_timings;
+    }
+    if (si.findMember(SI_PLAN) != nullptr) {
+        resp.m_plan = std::make_shared<RestorePlan>();
+        si.getMember(SI_PLAN) >>= *resp.m_plan;
+    }
+}
+
+void operator<<=(cxxtools::SerializationInfo& si, const SrrResetResponse& resp)
+{
+    si.addMember(SI_STATUS) <<= resp.m_status;
+    if (resp.m_status != dto::srr::statusToString(dto::srr::Status::SUCCESS)) {
+        si.addMember(SI_ERROR) <<= resp.m_error;
+    }
+    si.addMember(SI_STATUS_LIST) <<= resp.m_status_list;
+    if (!resp.m_timings.empty()) {
+        si.addMember(SI_TIMINGS) <<= resp.m_timings;
+    }
+    if (!resp.m_snapshot_id.empty()) {
+        si.addMember(SI_SNAPSHOT_ID) <<= resp.m_snapshot_id;
+    }
+}
+
+void operator>>=(const cxxtools::SerializationInfo& si, SrrResetResponse& resp)
+{
+    si.getMember(SI_STATUS) >>= resp.m_status;
+    if (si.findMember(SI_ERROR) != nullptr) {
+        si.getMember(SI_ERROR) >>= resp.m_error;
+    }
+    si.getMember(SI_STATUS_LIST) >>= resp.m_status_list;
+    if (si.findMember(SI_TIMINGS) != nullptr) {
+        si.getMember(SI_TIMINGS) >>= resp.m_timings;
+    }
+    if (si.findMember(SI_SNAPSHOT_ID) != nullptr) {
+        si.getMember(SI_SNAPSHOT_ID) >>= resp.m_snapshot_id;
+    }
 }
 
 } // namespace srr
@@ -22,7 +22,9 @@
 #pragma once
 
 #include "common.h"
+#include "plan.h"
 #include <cxxtools/serializationinfo.h>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -34,6 +36,10 @@ static constexpr const char* SI_PASSPHRASE_VALIDATION  = "passphrase_validation"
 // si restore response fields
 static constexpr const char* SI_STATUS_LIST = "status_list";
 
+// The responses stay cxxtools structures, unlike the save and reset requests: the feature data is a free-form Json
+// object embedded in the save response and the restore request, which needs the dynamic SerializationInfo tree.
+// The list response, sent once per UI session, keeps the same encoding as the other responses.
+
 class SrrListResponse
 {
 public:
@@ -59,6 +65,15 @@ public:
     std::string        m_version;
     std::string        m_checksum;
     std::vector<Group> m_data;
+
+    // optional, per group
+    std::vector<Timings> m_timings;
+
+    // optional, id of the local snapshot of this save
+    std::string m_snapshot_id;
+
+    // optional, snapshot used as base of a delta save
+    std::string m_base_snapshot_id;
 };
 
 void operator<<=(cxxtools::SerializationInfo& si, const SrrSaveResponse& resp);
@@ -71,9 +86,33 @@ public:
     std::string                m_status;
     std::string                m_error;
     std::vector<RestoreStatus> m_status_list;
+
+    // optional, per group (per feature for version 1.0)
+    std::vector<Timings> m_timings;
+
+    // optional, plan of a dry run
+    std::shared_ptr<RestorePlan> m_plan;
 };
 
 void operator<<=(cxxtools::SerializationInfo& si, const SrrRestoreResponse& resp);
 void operator>>=(const cxxtools::SerializationInfo& si, SrrRestoreResponse& resp);
 
+class SrrResetResponse
+{
+public:
+    SrrResetResponse(){};
+    std::string                m_status;
+    std::string                m_error;
+    std::vector<RestoreStatus> m_status_list; // per group
+
+    // optional, per group
+    std::vector<Timings> m_timings;
+
+    // optional, id of the local snapshot taken before the reset
+    std::string m_snapshot_id;
+};
+
+void operator<<=(cxxtools::SerializationInfo& si, const SrrResetResponse& resp);
+void operator>>=(const cxxtools::SerializationInfo& si, SrrResetResponse& resp);
+
 } // namespace srr
@@ -0,0 +1,93 @@
+/*  =========================================================================
+    fty_srr_server - Fty srr server
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+ */
+
+#include "dto/snapshot.h"
+
+namespace srr {
+void operator<<=(cxxtools::SerializationInfo& si, const SnapshotFeature& feature)
+{
+    si.addMember(SI_NAME) <<= feature.m_name;
+    si.addMember(SI_VERSION) <<= feature.m_version;
+    si.addMember(SI_STATUS) <<= feature.m_status;
+    si.addMember(SI_ERROR) <<= feature.m_error;
+    si.addMember(SI_HASH) <<= feature.m_hash;
+    si.addMember(SI_SIZE) <<= feature.m_size;
+}
+
+void operator>>=(const cxxtools::SerializationInfo& si, SnapshotFeature& feature)
+{
+    si.getMember(SI_NAME) >>= feature.m_name;
+    si.getMember(SI_VERSION) >>= feature.m_version;
+    si.getMember(SI_STATUS) >>= feature.m_status;
+    si.getMember(SI_ERROR) >>= feature.m_error;
+    si.getMember(SI_HASH) >>= feature.m_hash;
+    si.getMember(SI_SIZE) >>= feature.m_size;
+}
+
+void operator<<=(cxxtools::SerializationInfo& si, const SnapshotGroup& group)
+{
+    si.addMember(SI_GROUP_ID) <<= group.m_group_id;
+    si.addMember(SI_GROUP_NAME) <<= group.m_group_name;
+    si.addMember(SI_DATA_INTEGRITY) <<= group.m_data_integrity;
+    si.addMember(SI_FEATURES) <<= group.m_features;
+}
+
+void operator>>=(const cxxtools::SerializationInfo& si, SnapshotGroup& group)
+{
+    si.getMember(SI_GROUP_ID) >>= group.m_group_id;
+    si.getMember(SI_GROUP_NAME) >>= group.m_group_name;
+    si.getMember(SI_DATA_INTEGRITY) >>= group.m_data_integrity;
+    si.getMember(SI_FEATURES) >>= group.m_features;
+}
+
+void operator<<=(cxxtools::SerializationInfo& si, const SnapshotManifest& manifest)
+{
+    si.addMember(SI_ID) <<= manifest.m_id;
+    si.addMember(SI_DATE) <<= manifest.m_date;
+    si.addMember(SI_VERSION) <<= manifest.m_version;
+    si.addMember(SI_CHECKSUM) <<= manifest.m_checksum;
+    si.addMember(SI_SIZE) <<= manifest.m_size;
+    si.addMember(SI_WRITTEN) <<= manifest.m_written;
+    si.addMember(SI_GROUPS) <<= manifest.m_groups;
+}
+
+void operator>>=(const cxxtools::SerializationInfo& si, SnapshotManifest& manifest)
+{
+    si.getMember(SI_ID) >>= manifest.m_id;
+    si.getMember(SI_DATE) >>= manifest.m_date;
+    si.getMember(SI_VERSION) >>= manifest.m_version;
+    si.getMember(SI_CHECKSUM) >>= manifest.m_checksum;
+    si.getMember(SI_SIZE) >>= manifest.m_size;
+    si.getMember(SI_WRITTEN) >>= manifest.m_written;
+    si.getMember(SI_GROUPS) >>= manifest.m_groups;
+}
+
+void operator<<=(cxxtools::SerializationInfo& si, const SrrSnapshotListResponse& resp)
+{
+    si.addMember(SI_SNAPSHOTS) <<= resp.m_snapshots;
+}
+
+void operator>>=(const cxxtools::SerializationInfo& si, SrrSnapshotListResponse& resp)
+{
+    si.getMember(SI_SNAPSHOTS) >>= resp.m_snapshots;
+}
+
+} // namespace srr
@@ -0,0 +1,99 @@
+/*  =========================================================================
+    fty_srr_server - Fty srr server
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+ */
+
+#pragma once
+
+#include "common.h"
+#include <cstdint>
+#include <cxxtools/serializationinfo.h>
+#include <string>
+#include <vector>
+
+namespace srr {
+// si snapshot fields
+static constexpr const char* SI_SNAPSHOTS = "snapshots";
+static constexpr const char* SI_ID        = "id";
+static constexpr const char* SI_DATE      = "date";
+static constexpr const char* SI_HASH      = "hash";
+static constexpr const char* SI_SIZE      = "size";
+static constexpr const char* SI_WRITTEN   = "written";
+
+// feature of a stored snapshot, its data being stored in the blob named after its hash
+class SnapshotFeature
+{
+public:
+    SnapshotFeature(){};
+
+    std::string m_name;
+    std::string m_version;
+    std::string m_status;
+    std::string m_error;
+    std::string m_hash;
+    uint64_t    m_size = 0;
+};
+
+void operator<<=(cxxtools::SerializationInfo& si, const SnapshotFeature& feature);
+void operator>>=(const cxxtools::SerializationInfo& si, SnapshotFeature& feature);
+
+class SnapshotGroup
+{
+public:
+    SnapshotGroup(){};
+
+    std::string                  m_group_id;
+    std::string                  m_group_name;
+    std::string                  m_data_integrity;
+    std::vector<SnapshotFeature> m_features;
+};
+
+void operator<<=(cxxtools::SerializationInfo& si, const SnapshotGroup& group);
+void operator>>=(const cxxtools::SerializationInfo& si, SnapshotGroup& group);
+
+class SnapshotManifest
+{
+public:
+    SnapshotManifest(){};
+
+    std::string m_id;
+    std::string m_date;
+    std::string m_version;
+    std::string m_checksum;
+    uint64_t    m_size    = 0; // total size of the feature data
+    uint64_t    m_written = 0; // size of the blobs which were not already in the store
+
+    std::vector<SnapshotGroup> m_groups;
+};
+
+void operator<<=(cxxtools::SerializationInfo& si, const SnapshotManifest& manifest);
+void operator>>=(const cxxtools::SerializationInfo& si, SnapshotManifest& manifest);
+
+class SrrSnapshotListResponse
+{
+public:
+    SrrSnapshotListResponse(){};
+
+    std::vector<SnapshotManifest> m_snapshots;
+};
+
+void operator<<=(cxxtools::SerializationInfo& si, const SrrSnapshotListResponse& resp);
+void operator>>=(const cxxtools::SerializationInfo& si, SrrSnapshotListResponse& resp);
+
+} // namespace srr
@@ -21,6 +21,8 @@
 
 #include "dto/request.h"
 #include "dto/response.h"
+#include "dto/snapshot.h"
+#include "helpers/data_integrity.h"
 #include "helpers/utilsReauth.h"
 #include <cstdio>
 #include <cxxtools/serializationinfo.h>
@@ -31,8 +33,11 @@
 #include <fty_common_dto.h>
 #include <fty_common_messagebus.h>
 #include <fty_log.h>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <pack/serialization.h>
 #include <string>
 #include <vector>
 
@@ -58,13 +63,23 @@ std::ostream& operator<<(std::ostream& os, const std::vector<T>& vec)
 }
 // Utils
 dto::UserData sendRequest(const std::string& action, const dto::UserData& userData);
+void printTimings(const std::vector<srr::Timings>& timings, std::ostream& os);
+void printPlan(const srr::RestorePlan& plan, std::ostream& os);
+srr::SrrSaveResponse readSaveFile(const std::string& fileName);
+void sendRestoreRequest(const srr::SrrRestoreRequest& req, bool force);
 
 // operations
 std::vector<std::string> opList(void);
 void opSave(const std::string& passphrase, const std::string& sessionToken, const std::vector<std::string>& groupList,
-    std::ostream& os);
-void opRestore(const std::string& passphrase, const std::string& sessionToken, std::istream& is, bool force);
-void opReset(void);
+    const srr::SrrSaveRequest& base, std::ostream& os);
+void opRestore(const std::string& passphrase, const std::string& sessionToken, std::istream& is, bool force,
+    const srr::SrrRestoreRequest& options, const std::string& baseFileName);
+void opRestoreSnapshot(const std::string& passphrase, const std::string& sessionToken, const std::string& snapshotId,
+    bool force, const srr::SrrRestoreRequest& options);
+void opReset(const std::string& passphrase, const std::string& sessionToken, const std::vector<std::string>& groupList);
+void opTrace(std::ostream& os);
+void opMetrics(void);
+void opSnapshots(void);
 
 int main(int argc, char** argv)
 {
@@ -77,28 +92,40 @@ int main(int argc, char** argv)
     // remove log from fty-log
     ftylog_setLogLevelError(ftylog_getInstance());
 
-    bool help  = false;
-    bool force = false;
+    bool help   = false;
+    bool force  = false;
+    bool dryRun = false;
 
     std::string fileName;
     std::string groups;
     std::string passphrase;
     std::string passwd{};
     std::string sessionToken{};
+    std::string snapshotId;
+    std::string baseFileName;
+    std::string baseSnapshotId;
+    std::string include;
+    std::string exclude;
 
     if (std::getenv(SESSION_TOKEN_ENV_VAR)) {
         sessionToken = std::getenv(SESSION_TOKEN_ENV_VAR);
     }
 
     // clang-format off
-    fty::CommandLine cmd("### - SRR command line\n      Usage: fty-srr-cmd <list|save|restore|reset> [options]", {
+    fty::CommandLine cmd("### - SRR command line\n      Usage: fty-srr-cmd <list|save|restore|reset|trace|metrics|snapshots> [options]", {
         {"--help|-h", help, "Show this help"},
         {"--passphrase|-p", passphrase, "Passhphrase to save/restore groups"},
         {"--password|-pwd", passwd, "Password to restore groups (reauthentication)"},
         {"--token|-t", sessionToken, "Session token to save/restore groups if needed"},
-        {"--groups|-g", groups, "Select groups to save (default to all groups)"},
-        {"--file|-f", fileName, "Path to the JSON file to save/restore. If not specified, standard input/output is used"},
-        {"--force|-F", force, "Force restore (discards data integrity check)"}
+        {"--groups|-g", groups, "Select groups to save (default to all groups) or to reset"},
+        {"--file|-f", fileName, "Path to the JSON file to save/restore/trace. If not specified, standard input/output is used"},
+        {"--force|-F", force, "Force restore (discards data integrity check)"},
+        {"--dry-run|-n", dryRun, "Only show the restore plan and its estimated duration"},
+        {"--include|-i", include, "Groups or features to restore (default to all)"},
+        {"--exclude|-x", exclude, "Groups or features not to restore"},
+        {"--snapshot|-s", snapshotId, "Restore a local snapshot of the srr daemon instead of a file"},
+        {"--base|-b", baseFileName, "Previous save: save only the features which changed since / restore a delta save"},
+        {"--base-snapshot|-B", baseSnapshotId, "Local snapshot of the srr daemon used as base of a delta save"}
     });
 
     if(argc < 2) {
@@ -146,7 +173,19 @@ int main(int argc, char** argv)
             std::cout << "### - No group option specified\nSaving all groups" << std::endl;
             groupList = opList();
         }
-        opSave(passphrase, sessionToken, groupList, outputFile.is_open() ? outputFile : std::cout);
+        srr::SrrSaveRequest base;
+        if(!baseSnapshotId.empty()) {
+            base.m_base_snapshot_id.setValue(baseSnapshotId);
+        }
+        if(!baseFileName.empty()) {
+            try{
+                base.m_base_features.setValue(srr::evalFeatureHashes(readSaveFile(baseFileName).m_data));
+            } catch(const std::exception& e) {
+                std::cerr << "### - Can't read base file: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        opSave(passphrase, sessionToken, groupList, base, outputFile.is_open() ? outputFile : std::cout);
         if(outputFile.is_open()) {
             outputFile.close();
         }
@@ -164,6 +203,23 @@ int main(int argc, char** argv)
             std::cerr << "### - Wrong password, please retry" << std::endl;
             return EXIT_FAILURE;
         }
+        std::string reauthToken = srr::utils::buildReauthToken(sessionToken, passwd);
+
+        srr::SrrRestoreRequest options;
+        options.m_dry_run = dryRun;
+        if(!include.empty()) {
+            options.m_include = fty::split(include, ",", fty::SplitOption::Trim);
+            std::cout << "### - Restoring only: " << options.m_include << std::endl;
+        }
+        if(!exclude.empty()) {
+            options.m_exclude = fty::split(exclude, ",", fty::SplitOption::Trim);
+            std::cout << "### - Not restoring: " << options.m_exclude << std::endl;
+        }
+
+        if(!snapshotId.empty()) {
+            opRestoreSnapshot(passphrase, reauthToken, snapshotId, force, options);
+            return EXIT_SUCCESS;
+        }
         std::ifstream inputFile;
         if(!fileName.empty()) {
             try{
@@ -175,13 +231,50 @@ int main(int argc, char** argv)
         } else {
             std::cout << "### - No input file specified, waiting for input from stdin" << std::endl;
         }
-        std::string reauthToken = srr::utils::buildReauthToken(sessionToken, passwd);
-        opRestore(passphrase, reauthToken, inputFile.is_open() ? inputFile : std::cin, force);
+        opRestore(passphrase, reauthToken, inputFile.is_open() ? inputFile : std::cin, force, options, baseFileName);
         if(inputFile.is_open()) {
             inputFile.close();
         }
     } else if(operation == "reset") {
-        opReset();
+        if(passphrase.empty()) {
+            std::cerr << "### - Passphrase is required with reset operation (groups are saved before the reset)" << std::endl;
+            std::cout << cmd.help() << std::endl;
+            return EXIT_FAILURE;
+        }
+        if(passwd.empty()) {
+            std::cerr << "### - Password for reauthentication is required with reset operation" << std::endl;
+            std::cout << cmd.help() << std::endl;
+            return EXIT_FAILURE;
+        } else if(!srr::utils::isPasswordValidated(passwd)) {
+            std::cerr << "### - Wrong password, please retry" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if(groups.empty()) {
+            std::cerr << "### - Groups to reset are required with reset operation" << std::endl;
+            std::cout << cmd.help() << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::vector<std::string> groupList = fty::split(groups, ",", fty::SplitOption::Trim);
+        std::cout << "### - Resetting groups: " << groupList << std::endl;
+        opReset(passphrase, srr::utils::buildReauthToken(sessionToken, passwd), groupList);
+    } else if(operation == "trace") {
+        std::ofstream outputFile;
+        if(!fileName.empty()) {
+            try{
+                outputFile.open(fileName);
+            } catch(const std::exception& e) {
+                std::cerr << "### - Can't open output file: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        opTrace(outputFile.is_open() ? outputFile : std::cout);
+        if(outputFile.is_open()) {
+            outputFile.close();
+        }
+    } else if(operation == "metrics") {
+        opMetrics();
+    } else if(operation == "snapshots") {
+        opSnapshots();
     } else {
         std::cout << "### - Unknown operation" << std::endl;
         std::cout << std::endl;
@@ -218,6 +311,58 @@ dto::UserData sendRequest (const std::string &action,
     return resp.userData ();
 }
 
+void printTimings(const std::vector<srr::Timings>& timings, std::ostream& os) {
+    if(timings.empty()) {
+        return;
+    }
+
+    auto printRow = [&os](const std::string& name, const srr::Timings& t) {
+        os << std::left << std::setw(40) << name << std::right
+           << std::setw(10) << t.m_save_ms << std::setw(10) << t.m_backup_ms << std::setw(10) << t.m_reset_ms
+           << std::setw(10) << t.m_restore_ms << std::setw(10) << t.m_settle_ms << std::setw(10) << t.m_rollback_ms
+           << std::setw(14) << t.m_payload_bytes << std::endl;
+    };
+
+    os << std::left << std::setw(40) << "group / feature" << std::right
+       << std::setw(10) << "save" << std::setw(10) << "backup" << std::setw(10) << "reset"
+       << std::setw(10) << "restore" << std::setw(10) << "settle" << std::setw(10) << "rollback"
+       << std::setw(14) << "payload" << std::endl;
+    os << "(durations in ms, payload in bytes)" << std::endl;
+
+    for(const auto& group : timings) {
+        printRow(group.m_name, group);
+        for(const auto& feature : group.m_features) {
+            printRow("  " + feature.m_name, feature);
+        }
+    }
+}
+
+void printPlan(const srr::RestorePlan& plan, std::ostream& os) {
+    auto printSteps = [&os](const std::string& stage, const std::vector<srr::PlanStep>& steps) {
+        for(const auto& step : steps) {
+            os << "    " << std::left << std::setw(10) << stage << std::setw(40) << step.m_agent << std::right
+               << std::setw(10) << step.m_estimated_ms << "  " << step.m_features << std::endl;
+        }
+    };
+
+    os << "### - Restore plan (estimated duration " << plan.m_estimated_ms << " ms"
+       << (plan.m_reboot ? ", followed by a reboot" : "") << ")" << std::endl;
+    for(const auto& group : plan.m_groups) {
+        os << " - " << group.m_group_id;
+        if(!group.m_error.empty()) {
+            os << ": skipped (" << group.m_error << ")" << std::endl;
+            continue;
+        }
+        os << " (" << group.m_estimated_ms << " ms)" << std::endl;
+        printSteps("backup", group.m_backup);
+        printSteps("reset", group.m_reset);
+        printSteps("restore", group.m_restore);
+        if(!group.m_reload.empty()) {
+            os << "    reload    " << group.m_reload << std::endl;
+        }
+    }
+}
+
 std::vector<std::string> opList() {
     std::vector<std::string> groupList;
 
@@ -251,19 +396,37 @@ std::vector<std::string> opList() {
     return groupList;
 }
 
-void opSave(const std::string& passphrase, const std::string& sessionToken, const std::vector<std::string>& groupList, std::ostream& os) {
-    srr::SrrSaveRequest req;
-    req.m_group_list = groupList;
-    req.m_passphrase = passphrase;
-    req.m_sessionToken = sessionToken;
+srr::SrrSaveResponse readSaveFile(const std::string& fileName) {
+    std::ifstream file(fileName);
+    if(!file) {
+        throw std::runtime_error("Can't open " + fileName);
+    }
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
 
-    cxxtools::SerializationInfo reqSi;
+    cxxtools::SerializationInfo si;
+    JSON::readFromString(json, si);
 
-    reqSi <<= req;
+    srr::SrrSaveResponse save;
+    si >>= save;
+
+    return save;
+}
+
+void opSave(const std::string& passphrase, const std::string& sessionToken, const std::vector<std::string>& groupList,
+    const srr::SrrSaveRequest& base, std::ostream& os) {
+    srr::SrrSaveRequest req = base;
+    req.m_group_list.setValue(groupList);
+    req.m_passphrase.setValue(passphrase);
+    req.m_sessionToken.setValue(sessionToken);
 
     try {
+        auto reqJson = pack::json::serialize(req, pack::Option::WithDefaults);
+        if (!reqJson) {
+            throw std::runtime_error(reqJson.error());
+        }
+
         dto::UserData reqData;
-        reqData.push_back(JSON::writeToString(reqSi, false));
+        reqData.push_back(*reqJson);
 
         // Send request
         dto::UserData respData = sendRequest ("save", reqData);
@@ -285,6 +448,11 @@ void opSave(const std::string& passphrase, const std::string& sessionToken, cons
             std::cerr << "Error: " << resp.m_error << std::endl;
         }
 
+        // do not mix the table with the saved data
+        if(&os != &std::cout) {
+            printTimings(resp.m_timings, std::cout);
+        }
+
         os << respData.back() << std::endl;
     }
     catch (std::exception &e) {
@@ -292,7 +460,8 @@ void opSave(const std::string& passphrase, const std::string& sessionToken, cons
     }
 }
 
-void opRestore(const std::string& passphrase, const std::string& sessionToken, std::istream& is, bool force) {
+void opRestore(const std::string& passphrase, const std::string& sessionToken, std::istream& is, bool force,
+    const srr::SrrRestoreRequest& options, const std::string& baseFileName) {
     std::string reqJson;
     while(!is.eof()) {
         reqJson += static_cast<char>(is.get());
@@ -306,7 +475,7 @@ void opRestore(const std::string& passphrase, const std::string& sessionToken, s
         return;
     }
 
-    srr::SrrRestoreRequest req;
+    srr::SrrRestoreRequest req = options;
     req.m_passphrase = passphrase;
     req.m_sessionToken = sessionToken;
     siJson.getMember("version") >>= req.m_version;
@@ -319,12 +488,39 @@ void opRestore(const std::string& passphrase, const std::string& sessionToken, s
     } else if(req.m_version == "2.0" || req.m_version == "2.1") {
         srr::SrrRestoreRequestDataV2 reqData;
         siJson.getMember("data") >>= reqData.m_data;
+        // delta save: rebuild the unchanged features from the base file, or let the daemon use its snapshot
+        try{
+            if(!baseFileName.empty()) {
+                srr::applyDelta(reqData.m_data, readSaveFile(baseFileName).m_data);
+            } else if(siJson.findMember("base_snapshot_id") != nullptr) {
+                siJson.getMember("base_snapshot_id") >>= req.m_base_snapshot_id;
+            }
+        } catch(const std::exception& e) {
+            std::cerr << "### - Error: " << e.what () << std::endl;
+            return;
+        }
         req.m_data_ptr = std::shared_ptr<srr::SrrRestoreRequestData>(new srr::SrrRestoreRequestDataV2(reqData));
     } else {
         std::cerr << "### - Invalid SRR version" << std::endl;
         return;
     }
 
+    sendRestoreRequest(req, force);
+}
+
+void opRestoreSnapshot(const std::string& passphrase, const std::string& sessionToken, const std::string& snapshotId,
+    bool force, const srr::SrrRestoreRequest& options) {
+    // the version, the checksum and the data are read from the snapshot by the srr daemon
+    srr::SrrRestoreRequest req = options;
+    req.m_passphrase = passphrase;
+    req.m_sessionToken = sessionToken;
+    req.m_snapshot_id = snapshotId;
+
+    std::cout << "### - Restoring snapshot " << snapshotId << std::endl;
+    sendRestoreRequest(req, force);
+}
+
+void sendRestoreRequest(const srr::SrrRestoreRequest& req, bool force) {
     cxxtools::SerializationInfo reqSi;
     reqSi <<= req;
 
@@ -356,12 +552,116 @@ void opRestore(const std::string& passphrase, const std::string& sessionToken, s
         if(!resp.m_error.empty()) {
             std::cerr << "### - Error: " << resp.m_error << std::endl;
         }
+
+        if(resp.m_plan) {
+            printPlan(*resp.m_plan, std::cout);
+        }
+        printTimings(resp.m_timings, std::cout);
     }
     catch (std::exception &e) {
         std::cerr << "### - Error: " << e.what () << std::endl;
     }
 }
 
-void opReset() {
-    std::cerr << "Srr daemon does not handle reset operation" << std::endl;
+void opReset(const std::string& passphrase, const std::string& sessionToken, const std::vector<std::string>& groupList) {
+    srr::SrrResetRequest req;
+    req.m_group_list.setValue(groupList);
+    req.m_passphrase.setValue(passphrase);
+    req.m_sessionToken.setValue(sessionToken);
+
+    try {
+        auto reqJson = pack::json::serialize(req, pack::Option::WithDefaults);
+        if (!reqJson) {
+            throw std::runtime_error(reqJson.error());
+        }
+
+        dto::UserData reqData;
+        reqData.push_back(*reqJson);
+
+        // Send request
+        dto::UserData respData = sendRequest ("reset", reqData);
+        if (respData.empty ()) {
+            throw std::runtime_error (
+              "Impossible to reset requested groups");
+        }
+
+        srr::SrrResetResponse resp;
+
+        cxxtools::SerializationInfo respSi;
+        JSON::readFromString(respData.back(), respSi);
+
+        respSi >>= resp;
+
+        std::cout << "Request status: " << resp.m_status << std::endl;
+
+        if(!resp.m_error.empty()) {
+            std::cerr << "### - Error: " << resp.m_error << std::endl;
+        }
+        for(const auto& status : resp.m_status_list) {
+            std::cout << " - " << status.m_name << ": " << status.m_status;
+            if(!status.m_error.empty()) {
+                std::cout << " (" << status.m_error << ")";
+            }
+            std::cout << std::endl;
+        }
+        if(!resp.m_snapshot_id.empty()) {
+            std::cout << "Snapshot taken before the reset: " << resp.m_snapshot_id << std::endl;
+        }
+
+        printTimings(resp.m_timings, std::cout);
+    }
+    catch (std::exception &e) {
+        std::cerr << "### - Error: " << e.what () << std::endl;
+    }
+}
+
+void opTrace(std::ostream& os) {
+    try {
+        dto::UserData respData = sendRequest ("trace", {});
+        if (respData.empty ()) {
+            throw std::runtime_error ("Impossible to get the trace");
+        }
+        os << respData.front() << std::endl;
+    }
+    catch (std::exception &e) {
+        std::cerr << "### - Error: " << e.what () << std::endl;
+    }
+}
+
+void opMetrics() {
+    try {
+        dto::UserData respData = sendRequest ("metrics", {});
+        if (respData.empty ()) {
+            throw std::runtime_error ("Impossible to get the metrics");
+        }
+        std::cout << respData.front();
+    }
+    catch (std::exception &e) {
+        std::cerr << "### - Error: " << e.what () << std::endl;
+    }
+}
+
+void opSnapshots() {
+    try {
+        dto::UserData respData = sendRequest ("snapshots", {});
+        if (respData.empty ()) {
+            throw std::runtime_error ("Impossible to get the list of snapshots");
+        }
+
+        srr::SrrSnapshotListResponse resp;
+
+        cxxtools::SerializationInfo si;
+        JSON::readFromString(respData.front(), si);
+
+        si >>= resp;
+
+        std::cout << "### Snapshots available:" << std::endl;
+        for(const auto& snapshot : resp.m_snapshots) {
+            std::cout << " - " << snapshot.m_id << " (" << snapshot.m_groups.size() << " groups, " << snapshot.m_size
+                      << " bytes, " << snapshot.m_written << " bytes written)" << std::endl;
+        }
+    }
+    catch (std::exception &e) {
+        std::cerr << "### - Error: " << e.what () << std::endl;
+    }
 }
@@ -22,6 +22,7 @@
 #include "fty-srr.h"
 #include "fty_common_mlm.h"
 #include "fty_srr_exception.h"
+#include "fty_srr_groups.h"
 #include "fty_srr_manager.h"
 #include "fty_srr_worker.h"
 #include <csignal>
@@ -104,24 +105,58 @@ int main(int argc, char* argv[])
     }
 
     // Default parameters
-    paramsConfig[AGENT_NAME_KEY]      = AGENT_NAME;
-    paramsConfig[ENDPOINT_KEY]        = DEFAULT_ENDPOINT;
-    paramsConfig[SRR_QUEUE_NAME_KEY]  = SRR_MSG_QUEUE_NAME;
-    paramsConfig[SRR_VERSION_KEY]     = ACTIVE_VERSION;
-    paramsConfig[REQUEST_TIMEOUT_KEY] = DefaultTimeOut;
-    paramsConfig[ENABLE_REBOOT_KEY]   = ENABLE_REBOOT_DEFAULT;
+    paramsConfig[AGENT_NAME_KEY]         = AGENT_NAME;
+    paramsConfig[ENDPOINT_KEY]           = DEFAULT_ENDPOINT;
+    paramsConfig[SRR_QUEUE_NAME_KEY]     = SRR_MSG_QUEUE_NAME;
+    paramsConfig[SRR_VERSION_KEY]        = ACTIVE_VERSION;
+    paramsConfig[REQUEST_TIMEOUT_KEY]    = DefaultTimeOut;
+    paramsConfig[ENABLE_REBOOT_KEY]      = ENABLE_REBOOT_DEFAULT;
+    paramsConfig[LICENSE_CACHE_TTL_KEY]  = LICENSE_CACHE_TTL_DEFAULT;
+    paramsConfig[BUS_POOL_SIZE_KEY]      = BUS_POOL_SIZE_DEFAULT;
+    paramsConfig[SAVE_TIMEOUT_KEY]       = SAVE_TIMEOUT_DEFAULT;
+    paramsConfig[PREFLIGHT_KEY]          = PREFLIGHT_DEFAULT;
+    paramsConfig[PREFLIGHT_TIMEOUT_KEY]  = PREFLIGHT_TIMEOUT_DEFAULT;
+    paramsConfig[TRACE_KEY]              = TRACE_DEFAULT;
+    paramsConfig[TRACE_DIR_KEY]          = TRACE_DIR_DEFAULT;
+    paramsConfig[METRICS_FILE_KEY]       = METRICS_FILE_DEFAULT;
+    paramsConfig[METRICS_PERIOD_KEY]     = METRICS_PERIOD_DEFAULT;
+    paramsConfig[SNAPSHOT_DIR_KEY]       = SNAPSHOT_DIR_DEFAULT;
+    paramsConfig[SNAPSHOT_RETENTION_KEY] = SNAPSHOT_RETENTION_DEFAULT;
+    paramsConfig[SAVE_CACHE_STREAM_KEY]  = SAVE_CACHE_STREAM_DEFAULT;
+    paramsConfig[SAVE_CACHE_TTL_KEY]     = SAVE_CACHE_TTL_DEFAULT;
 
     if (config_file) {
         log_debug((AGENT_NAME + std::string(": loading configuration file from ") + config_file).c_str());
         mlm::ZConfig config(config_file);
         // verbose mode
         std::istringstream(config.getEntry("server/verbose", "0")) >> verbose;
-        paramsConfig[REQUEST_TIMEOUT_KEY] = config.getEntry("server/timeout", DefaultTimeOut);
-        paramsConfig[ENDPOINT_KEY]        = config.getEntry("srr-msg-bus/endpoint", DEFAULT_ENDPOINT);
-        paramsConfig[AGENT_NAME_KEY]      = config.getEntry("srr-msg-bus/address", AGENT_NAME);
-        paramsConfig[SRR_QUEUE_NAME_KEY]  = config.getEntry("srr-msg-bus/srrQueueName", SRR_MSG_QUEUE_NAME);
-        paramsConfig[SRR_VERSION_KEY]     = config.getEntry("srr/version", ACTIVE_VERSION);
-        paramsConfig[ENABLE_REBOOT_KEY]   = config.getEntry("srr/enableReboot", ENABLE_REBOOT_DEFAULT);
+        paramsConfig[REQUEST_TIMEOUT_KEY]    = config.getEntry("server/timeout", DefaultTimeOut);
+        paramsConfig[ENDPOINT_KEY]           = config.getEntry("srr-msg-bus/endpoint", DEFAULT_ENDPOINT);
+        paramsConfig[AGENT_NAME_KEY]         = config.getEntry("srr-msg-bus/address", AGENT_NAME);
+        paramsConfig[BUS_POOL_SIZE_KEY]      = config.getEntry("srr-msg-bus/poolSize", BUS_POOL_SIZE_DEFAULT);
+        paramsConfig[SRR_QUEUE_NAME_KEY]     = config.getEntry("srr-msg-bus/srrQueueName", SRR_MSG_QUEUE_NAME);
+        paramsConfig[SRR_VERSION_KEY]        = config.getEntry("srr/version", ACTIVE_VERSION);
+        paramsConfig[ENABLE_REBOOT_KEY]      = config.getEntry("srr/enableReboot", ENABLE_REBOOT_DEFAULT);
+        paramsConfig[LICENSE_CACHE_TTL_KEY]  = config.getEntry("srr/licenseCacheTtl", LICENSE_CACHE_TTL_DEFAULT);
+        paramsConfig[SAVE_TIMEOUT_KEY]       = config.getEntry("srr/saveTimeout", SAVE_TIMEOUT_DEFAULT);
+        paramsConfig[PREFLIGHT_KEY]          = config.getEntry("srr/preflight", PREFLIGHT_DEFAULT);
+        paramsConfig[PREFLIGHT_TIMEOUT_KEY]  = config.getEntry("srr/preflightTimeout", PREFLIGHT_TIMEOUT_DEFAULT);
+        paramsConfig[TRACE_KEY]              = config.getEntry("srr/trace", TRACE_DEFAULT);
+        paramsConfig[TRACE_DIR_KEY]          = config.getEntry("srr/traceDir", TRACE_DIR_DEFAULT);
+        paramsConfig[METRICS_FILE_KEY]       = config.getEntry("srr/metricsFile", METRICS_FILE_DEFAULT);
+        paramsConfig[METRICS_PERIOD_KEY]     = config.getEntry("srr/metricsPeriod", METRICS_PERIOD_DEFAULT);
+        paramsConfig[SNAPSHOT_DIR_KEY]       = config.getEntry("srr/snapshotDir", SNAPSHOT_DIR_DEFAULT);
+        paramsConfig[SNAPSHOT_RETENTION_KEY] = config.getEntry("srr/snapshotRetention", SNAPSHOT_RETENTION_DEFAULT);
+        paramsConfig[SAVE_CACHE_STREAM_KEY]  = config.getEntry("srr/saveCacheStream", SAVE_CACHE_STREAM_DEFAULT);
+        paramsConfig[SAVE_CACHE_TTL_KEY]     = config.getEntry("srr/saveCacheTtl", SAVE_CACHE_TTL_DEFAULT);
+
+        // fixed timeouts of specific agent queues, in seconds
+        for (const auto& agent : srr::g_agentToQueue) {
+            const std::string timeout = config.getEntry("agent-timeouts/" + agent.second, "");
+            if (!timeout.empty()) {
+                paramsConfig[AGENT_TIMEOUT_KEY_PREFIX + agent.second] = timeout;
+            }
+        }
     }
 
     if (verbose) {
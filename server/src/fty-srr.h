@@ -23,16 +23,43 @@
 #define FTY_SRR_H_H_INCLUDED
 
 //  SRR agent configuration
-constexpr auto REQUEST_TIMEOUT_KEY   = "requestTimeOut";
-constexpr auto AGENT_NAME_KEY        = "agentName";
-constexpr auto AGENT_NAME            = "fty-srr";
-constexpr auto ENDPOINT_KEY          = "endPoint";
-constexpr auto DEFAULT_ENDPOINT      = "ipc://@/malamute";
-constexpr auto DEFAULT_LOG_CONFIG    = "/etc/fty/ftylog.cfg";
-constexpr auto SRR_QUEUE_NAME_KEY    = "queueName";
-constexpr auto SRR_MSG_QUEUE_NAME    = "ETN.Q.IPMCORE.SRR";
-constexpr auto ENABLE_REBOOT_KEY     = "enableReboot";
-constexpr auto ENABLE_REBOOT_DEFAULT = "true";
+constexpr auto REQUEST_TIMEOUT_KEY        = "requestTimeOut";
+constexpr auto AGENT_NAME_KEY             = "agentName";
+constexpr auto AGENT_NAME                 = "fty-srr";
+constexpr auto ENDPOINT_KEY               = "endPoint";
+constexpr auto DEFAULT_ENDPOINT           = "ipc://@/malamute";
+constexpr auto DEFAULT_LOG_CONFIG         = "/etc/fty/ftylog.cfg";
+constexpr auto SRR_QUEUE_NAME_KEY         = "queueName";
+constexpr auto SRR_MSG_QUEUE_NAME         = "ETN.Q.IPMCORE.SRR";
+constexpr auto ENABLE_REBOOT_KEY          = "enableReboot";
+constexpr auto ENABLE_REBOOT_DEFAULT      = "true";
+constexpr auto LICENSE_CACHE_TTL_KEY      = "licenseCacheTtl";
+constexpr auto LICENSE_CACHE_TTL_DEFAULT  = "300";
+constexpr auto BUS_POOL_SIZE_KEY          = "busPoolSize";
+constexpr auto BUS_POOL_SIZE_DEFAULT      = "4";
+constexpr auto SAVE_TIMEOUT_KEY           = "saveTimeout";
+constexpr auto SAVE_TIMEOUT_DEFAULT       = "60";
+constexpr auto AGENT_TIMEOUT_KEY_PREFIX   = "agentTimeout.";
+constexpr auto PREFLIGHT_KEY              = "preflight";
+constexpr auto PREFLIGHT_DEFAULT          = "exclude";
+constexpr auto PREFLIGHT_TIMEOUT_KEY      = "preflightTimeout";
+constexpr auto PREFLIGHT_TIMEOUT_DEFAULT  = "500";
+constexpr auto TRACE_KEY                  = "trace";
+constexpr auto TRACE_DEFAULT              = "false";
+constexpr auto TRACE_DIR_KEY              = "traceDir";
+constexpr auto TRACE_DIR_DEFAULT          = "";
+constexpr auto METRICS_FILE_KEY           = "metricsFile";
+constexpr auto METRICS_FILE_DEFAULT       = "";
+constexpr auto METRICS_PERIOD_KEY         = "metricsPeriod";
+constexpr auto METRICS_PERIOD_DEFAULT     = "60";
+constexpr auto SNAPSHOT_DIR_KEY           = "snapshotDir";
+constexpr auto SNAPSHOT_DIR_DEFAULT       = "";
+constexpr auto SNAPSHOT_RETENTION_KEY     = "snapshotRetention";
+constexpr auto SNAPSHOT_RETENTION_DEFAULT = "10";
+constexpr auto SAVE_CACHE_STREAM_KEY      = "saveCacheStream";
+constexpr auto SAVE_CACHE_STREAM_DEFAULT  = "";
+constexpr auto SAVE_CACHE_TTL_KEY         = "saveCacheTtl";
+constexpr auto SAVE_CACHE_TTL_DEFAULT     = "3600";
 
 // AGENTS AND QUEUES
 // Config agent definition
@@ -89,6 +116,8 @@ constexpr auto F_USER_SESSION_MANAGEMENT_FEATURE_NAME = "user-session-management
 constexpr auto F_VIRTUAL_ASSETS                       = "virtual-assets";
 constexpr auto F_VIRTUALIZATION_SETTINGS              = "virtualization-settings";
 constexpr auto F_AI_SETTINGS                          = "ai-settings";
+// Feature of no agent: the agents answer its save with an error, without saving anything
+constexpr auto F_PING = "srr-ping";
 // Common definition
 constexpr auto SRR_VERSION_KEY          = "version";
 constexpr auto ACTIVE_VERSION           = "2.1";
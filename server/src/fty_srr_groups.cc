@@ -42,6 +42,21 @@ unsigned int getPriority(const std::string& featureName)
     }
 }
 
+std::vector<std::string> getResetFeatures(const std::string& groupId)
+{
+    std::vector<SrrFeaturePriorityStruct> featureList = g_srrGroupMap.at(groupId).m_fp;
+    std::stable_sort(featureList.begin(), featureList.end(),
+        [](const SrrFeaturePriorityStruct& l, const SrrFeaturePriorityStruct& r) {
+            return l.m_priority > r.m_priority;
+        });
+
+    std::vector<std::string> features;
+    for (const auto& fp : featureList) {
+        features.push_back(fp.m_feature);
+    }
+    return features;
+}
+
 std::string getGroupFromFeature(const std::string& featureName)
 {
     std::string groupId;
@@ -31,6 +31,8 @@
 namespace srr {
 std::string  getGroupFromFeature(const std::string& featureName);
 unsigned int getPriority(const std::string& featureName);
+// features of a group in reset order, the reverse of their priority order
+std::vector<std::string> getResetFeatures(const std::string& groupId);
 
 typedef struct SrrFeatureStruct
 {
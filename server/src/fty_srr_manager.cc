@@ -23,6 +23,8 @@
 #include "fty-srr.h"
 #include "fty_srr_exception.h"
 #include "fty_srr_worker.h"
+#include "helpers/busPool.h"
+#include "helpers/metrics.h"
 #include <algorithm>
 #include <functional>
 #include <thread>
@@ -36,10 +38,13 @@ namespace srr
 {
     
     const std::map<const std::string, RequestType> SrrRequestProcessor::m_requestType = {
-        {"list"    , RequestType::REQ_LIST},
-        {"save"    , RequestType::REQ_SAVE},
-        {"restore" , RequestType::REQ_RESTORE},
-        {"reset"   , RequestType::REQ_RESET}
+        {"list"      , RequestType::REQ_LIST},
+        {"save"      , RequestType::REQ_SAVE},
+        {"restore"   , RequestType::REQ_RESTORE},
+        {"reset"     , RequestType::REQ_RESET},
+        {"trace"     , RequestType::REQ_TRACE},
+        {"metrics"   , RequestType::REQ_METRICS},
+        {"snapshots" , RequestType::REQ_SNAPSHOTS}
     };
 
     dto::UserData SrrRequestProcessor::processRequest(const std::string& operation, const dto::UserData& data)
@@ -69,6 +74,21 @@ namespace srr
                 if(!resetHandler) throw std::runtime_error("No reset handler!");
                 response = resetHandler(data.front());
                 break;
+
+            case RequestType::REQ_TRACE :
+                if(!traceHandler) throw std::runtime_error("No trace handler!");
+                response = traceHandler();
+                break;
+
+            case RequestType::REQ_METRICS :
+                if(!metricsHandler) throw std::runtime_error("No metrics handler!");
+                response = metricsHandler();
+                break;
+
+            case RequestType::REQ_SNAPSHOTS :
+                if(!snapshotsHandler) throw std::runtime_error("No snapshots handler!");
+                response = snapshotsHandler();
+                break;
             
             case RequestType::REQ_UNKNOWN:
             default:
@@ -83,12 +103,16 @@ namespace srr
      * Constructor
      * @param parameters
      * @param streamPublisher
+     * @param clock
      */
-    SrrManager::SrrManager(const std::map<std::string, std::string> & parameters)
+    SrrManager::SrrManager(const std::map<std::string, std::string> & parameters, Clock& clock)
     : m_parameters(parameters)
+    , m_clock(clock)
     {
         init();
     }
+
+    SrrManager::~SrrManager() = default;
     
     /**
      * Class initialization 
@@ -97,22 +121,29 @@ namespace srr
     {
         try
         {
-            // Back end bus init
-            m_backEndBus = std::unique_ptr<messagebus::MessageBus>(messagebus::MlmMessageBus(m_parameters.at(ENDPOINT_KEY), m_parameters.at(AGENT_NAME_KEY)));
-            m_backEndBus->connect();
+            // Back end bus pool init
+            m_backEndPool = std::unique_ptr<srr::MessageBusPool>(new srr::MessageBusPool(m_parameters.at(ENDPOINT_KEY), m_parameters.at(AGENT_NAME_KEY), std::stoul(m_parameters.at(BUS_POOL_SIZE_KEY))));
             
             // UI messagebus bus init
             m_uiBus = std::unique_ptr<messagebus::MessageBus>(messagebus::MlmMessageBus(m_parameters.at(ENDPOINT_KEY), m_parameters.at(AGENT_NAME_KEY) + "-ui"));
             m_uiBus->connect();
             
             // Worker creation.
-            m_srrworker = std::unique_ptr<srr::SrrWorker>(new srr::SrrWorker(*m_backEndBus, m_parameters, {"1.0", "2.0", "2.1"}));
+            m_srrworker = std::unique_ptr<srr::SrrWorker>(new srr::SrrWorker(*m_backEndPool, m_parameters, {"1.0", "2.0", "2.1"}, m_clock));
             
             // Bind all processor handler.
             m_processor.listHandler = std::bind(&SrrWorker::getGroupList, m_srrworker.get());
             m_processor.saveHandler = std::bind(&SrrWorker::requestSave, m_srrworker.get(), _1);
             m_processor.restoreHandler = std::bind(&SrrWorker::requestRestore, m_srrworker.get(), _1, _2);
             m_processor.resetHandler = std::bind(&SrrWorker::requestReset, m_srrworker.get(), _1);
+            m_processor.traceHandler = std::bind(&SrrWorker::getTrace, m_srrworker.get());
+            m_processor.metricsHandler = []() { return dto::UserData{Metrics::instance().prometheusText()}; };
+            m_processor.snapshotsHandler = std::bind(&SrrWorker::getSnapshotList, m_srrworker.get());
+
+            // Metrics file for the node exporter
+            if (!m_parameters.at(METRICS_FILE_KEY).empty()) {
+                m_metricsWriter = std::unique_ptr<MetricsFileWriter>(new MetricsFileWriter(m_parameters.at(METRICS_FILE_KEY), std::chrono::seconds(std::stoi(m_parameters.at(METRICS_PERIOD_KEY)))));
+            }
             
             // Listen all incoming UI requests           
             auto uiFct = std::bind(&SrrManager::handleRequest, this, _1);
@@ -135,20 +166,43 @@ namespace srr
 
         dto::UserData response;
 
+        const auto  start = std::chrono::steady_clock::now();
+        std::string op;
+
+        // the fixed delays of the request are accounted to it
+        m_clock.beginOperation();
+        std::string status = statusToString(Status::SUCCESS);
+
         try
         {
-            const std::string& op = msg.metaData().at(messagebus::Message::SUBJECT);
+            op = msg.metaData().at(messagebus::Message::SUBJECT);
 
             response = m_processor.processRequest(op, msg.userData());
+            // save and restore responses start with the operation status
+            if (response.size() > 1) {
+                status = response.front();
+            }
             // Send response
         }        
         catch (std::exception& ex)
         {
+            status = statusToString(Status::FAILED);
             response.push_back(ex.what());
             log_error(ex.what());
         }
 
-        sendUiResponse(msg, response);
+        // the operation is over once the UI gets the response
+        m_clock.endOperation();
+
+        sendUiResponse(msg, std::move(response));
+
+        if (op != "trace" && op != "metrics" && op != "snapshots") {
+            Metrics::instance().operation(op, status, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+        }
+
+        const MessageBusPool::Stats stats = m_backEndPool->stats();
+        log_debug("Back end bus pool: %zu/%zu clients in use (peak %zu), %llu checkouts, %llu waited", stats.m_inUse, stats.m_size, stats.m_peakInUse,
+            static_cast<unsigned long long>(stats.m_checkouts), static_cast<unsigned long long>(stats.m_waits));
     }
 
     /**
@@ -182,7 +236,8 @@ namespace srr
             respMsg.metaData().emplace(messagebus::Message::FROM, m_parameters.at(AGENT_NAME_KEY));
             respMsg.metaData().emplace(messagebus::Message::TO, msg.metaData().find(messagebus::Message::FROM)->second);
             respMsg.metaData().emplace(messagebus::Message::CORRELATION_ID, msg.metaData().find(messagebus::Message::CORRELATION_ID)->second);
-            m_backEndBus->sendReply(msg.metaData().find(messagebus::Message::REPLY_TO)->second, respMsg);
+            auto bus = m_backEndPool->checkout();
+            bus.bus().sendReply(msg.metaData().find(messagebus::Message::REPLY_TO)->second, respMsg);
         }
         catch (messagebus::MessageBusException& ex)
         {
@@ -198,12 +253,12 @@ namespace srr
      * @param msg
      * @param userData
      */
-    void SrrManager::sendUiResponse(const messagebus::Message& msg, const dto::UserData& userData)
+    void SrrManager::sendUiResponse(const messagebus::Message& msg, dto::UserData userData)
     {
         try
         {
             messagebus::Message respMsg;
-            respMsg.userData() = userData;
+            respMsg.userData() = std::move(userData);
             respMsg.metaData().emplace(messagebus::Message::SUBJECT, msg.metaData().at(messagebus::Message::SUBJECT));
             respMsg.metaData().emplace(messagebus::Message::FROM, m_parameters.at(AGENT_NAME_KEY));
             respMsg.metaData().emplace(messagebus::Message::TO, msg.metaData().find(messagebus::Message::FROM)->second);
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include "helpers/clock.h"
 #include <fty_common_dto.h>
 #include <fty_common_messagebus.h>
 #include <fty_userdata_dto.h>
@@ -30,6 +31,8 @@
 
 /// Agent srr server
 namespace srr {
+class MessageBusPool;
+class MetricsFileWriter;
 class SrrWorker;
 
 enum class RequestType
@@ -38,7 +41,10 @@ enum class RequestType
     REQ_LIST,
     REQ_SAVE,
     REQ_RESTORE,
-    REQ_RESET
+    REQ_RESET,
+    REQ_TRACE,
+    REQ_METRICS,
+    REQ_SNAPSHOTS
 };
 
 class SrrRequestProcessor
@@ -50,6 +56,9 @@ public:
     std::function<dto::UserData(const std::string&)>       saveHandler;
     std::function<dto::UserData(const std::string&, bool)> restoreHandler;
     std::function<dto::UserData(const std::string&)>       resetHandler;
+    std::function<dto::UserData()>                         traceHandler;
+    std::function<dto::UserData()>                         metricsHandler;
+    std::function<dto::UserData()>                         snapshotsHandler;
 
     dto::UserData processRequest(const std::string& operation, const dto::UserData& data);
 };
@@ -57,16 +66,18 @@ public:
 class SrrManager
 {
 public:
-    explicit SrrManager(const std::map<std::string, std::string>& parameters);
-    ~SrrManager() = default;
+    explicit SrrManager(const std::map<std::string, std::string>& parameters, Clock& clock = Clock::system());
+    ~SrrManager();
 
 private:
     std::map<std::string, std::string> m_parameters;
-    // back end bus handles communication with all the agents (can't receive requests)
-    std::unique_ptr<messagebus::MessageBus> m_backEndBus;
+    Clock&                             m_clock;
+    // back end bus clients handle communication with all the agents (can't receive requests)
+    std::unique_ptr<srr::MessageBusPool> m_backEndPool;
     // UI bus handles incoming requests from UI
     std::unique_ptr<messagebus::MessageBus> m_uiBus;
     std::unique_ptr<srr::SrrWorker>         m_srrworker;
+    std::unique_ptr<MetricsFileWriter>      m_metricsWriter;
 
     SrrRequestProcessor m_processor;
 
@@ -74,7 +85,7 @@ private:
     void handleRequest(messagebus::Message msg);
 
     void sendResponse(const messagebus::Message& msg, const dto::UserData& userData);
-    void sendUiResponse(const messagebus::Message& msg, const dto::UserData& userData);
+    void sendUiResponse(const messagebus::Message& msg, dto::UserData userData);
 
     void uiMsgHandler(const messagebus::Message& msg);
 };
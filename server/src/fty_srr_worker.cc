@@ -22,18 +22,28 @@
 #include "fty_srr_worker.h"
 #include "dto/request.h"
 #include "dto/response.h"
+#include "dto/snapshot.h"
 #include "fty-srr.h"
 #include "fty_srr_exception.h"
 #include "fty_srr_groups.h"
+#include "helpers/busPool.h"
 #include "helpers/data_integrity.h"
+#include "helpers/licensing.h"
+#include "helpers/metrics.h"
 #include "helpers/passPhrase.h"
+#include "helpers/restorePlan.h"
+#include "helpers/saveCache.h"
+#include "helpers/snapshotStore.h"
+#include "helpers/trace.h"
 #include "helpers/utils.h"
 #include <chrono>
 #include <cstdlib>
+#include <fstream>
 #include <fty-lib-certificate.h>
 #include <fty_common.h>
 #include <fty_common_mlm.h>
-#include <fty_common_mlm_pool.h>
+#include <future>
+#include <google/protobuf/arena.h>
 #include <iostream>
 #include <numeric>
 #include <pack/serialization.h>
@@ -44,23 +54,32 @@
 #define SRR_RESTART_DELAY_SEC     5
 #define FEATURE_RESTORE_DELAY_SEC 6
 
+#define PREFLIGHT_OFF     "off"
+#define PREFLIGHT_EXCLUDE "exclude"
+#define PREFLIGHT_REFUSE  "refuse"
+
 using namespace dto::srr;
 
 namespace srr {
 /**
  * Constructor
- * @param msgBus
+ * @param busPool
  * @param parameters
+ * @param supportedVersions
+ * @param clock Clock used for the fixed delays of the restore procedure
  */
-SrrWorker::SrrWorker(messagebus::MessageBus& msgBus, const std::map<std::string, std::string>& parameters,
-    const std::set<std::string>& supportedVersions)
-    : m_msgBus(msgBus)
+SrrWorker::SrrWorker(MessageBusPool& busPool, const std::map<std::string, std::string>& parameters,
+    const std::set<std::string>& supportedVersions, Clock& clock)
+    : m_busPool(busPool)
     , m_parameters(parameters)
+    , m_clock(clock)
     , m_supportedVersions(supportedVersions)
 {
     init();
 }
 
+SrrWorker::~SrrWorker() = default;
+
 /**
  * Init srr worker
  */
@@ -69,11 +88,94 @@ void SrrWorker::init()
     try {
         m_srrVersion  = m_parameters.at(SRR_VERSION_KEY);
         m_sendTimeout = std::stoi(m_parameters.at(REQUEST_TIMEOUT_KEY)) / 1000;
+
+        // hard caps of the agent request timeouts, per operation
+        m_agentLatency.setCap(AgentOperation::SAVE, std::chrono::seconds(std::stoi(m_parameters.at(SAVE_TIMEOUT_KEY))));
+        m_agentLatency.setCap(AgentOperation::RESTORE, std::chrono::seconds(m_sendTimeout));
+        m_agentLatency.setCap(AgentOperation::RESET, std::chrono::seconds(m_sendTimeout));
+        // an interrupted restore or reset leaves the feature half written, only the saves are adapted
+        m_agentLatency.setFloor(AgentOperation::RESTORE, std::chrono::seconds(m_sendTimeout));
+        m_agentLatency.setFloor(AgentOperation::RESET, std::chrono::seconds(m_sendTimeout));
+
+        // configured timeouts of specific agent queues
+        const std::string overridePrefix(AGENT_TIMEOUT_KEY_PREFIX);
+        for (const auto& param : m_parameters) {
+            if (param.first.compare(0, overridePrefix.size(), overridePrefix) == 0) {
+                m_agentLatency.setOverride(
+                    param.first.substr(overridePrefix.size()), std::chrono::seconds(std::stoi(param.second)));
+            }
+        }
+
+        m_preflightMode    = m_parameters.at(PREFLIGHT_KEY);
+        m_preflightTimeout = std::chrono::milliseconds(std::stoi(m_parameters.at(PREFLIGHT_TIMEOUT_KEY)));
+        if (m_preflightMode != PREFLIGHT_OFF && m_preflightMode != PREFLIGHT_EXCLUDE &&
+            m_preflightMode != PREFLIGHT_REFUSE) {
+            throw std::runtime_error("Invalid preflight mode " + m_preflightMode);
+        }
+
+        Tracer::instance().setEnabled(m_parameters.at(TRACE_KEY) == "true");
+        m_traceDir = m_parameters.at(TRACE_DIR_KEY);
+
+        if (!m_parameters.at(SNAPSHOT_DIR_KEY).empty()) {
+            const auto retention = static_cast<unsigned>(std::stoul(m_parameters.at(SNAPSHOT_RETENTION_KEY)));
+            m_snapshotStore =
+                std::unique_ptr<SnapshotStore>(new SnapshotStore(m_parameters.at(SNAPSHOT_DIR_KEY), retention));
+        }
+
+        const auto licenseCacheTtl = std::chrono::seconds(std::stoi(m_parameters.at(LICENSE_CACHE_TTL_KEY)));
+        m_licenseCache             = std::unique_ptr<LicenseCache>(new LicenseCache(
+            m_parameters.at(ENDPOINT_KEY), m_parameters.at(AGENT_NAME_KEY) + "-licensing", licenseCacheTtl));
+
+        if (!m_parameters.at(SAVE_CACHE_STREAM_KEY).empty()) {
+            const auto saveCacheTtl = std::chrono::seconds(std::stoi(m_parameters.at(SAVE_CACHE_TTL_KEY)));
+            m_saveCache = std::unique_ptr<SaveCache>(new SaveCache(m_parameters.at(ENDPOINT_KEY),
+                m_parameters.at(AGENT_NAME_KEY) + "-savecache", m_parameters.at(SAVE_CACHE_STREAM_KEY), saveCacheTtl,
+                [this](const FeatureName& featureName, const std::string& passphrase, const std::string& sessionToken) {
+                    return saveFeatureShared(featureName, passphrase, sessionToken);
+                }));
+        }
     } catch (const std::exception& ex) {
         throw SrrException(ex.what());
     }
 }
 
+static uint64_t durationMs(Clock::TimePoint start, Clock::TimePoint end)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+}
+
+static uint64_t msSince(std::chrono::steady_clock::time_point start)
+{
+    return durationMs(start, std::chrono::steady_clock::now());
+}
+
+static std::string joinNames(const std::set<std::string>& names)
+{
+    std::string joined;
+    for (const auto& name : names) {
+        joined += (joined.empty() ? "" : ", ") + name;
+    }
+    return joined;
+}
+
+messagebus::Message SrrWorker::sendAgentRequest(AgentOperation op, dto::UserData data, const std::string& action,
+    const std::string& queueNameDest, const std::string& agentNameDest)
+{
+    const std::chrono::seconds timeout = m_agentLatency.timeout(queueNameDest, op);
+
+    auto       bus   = m_busPool.checkout();
+    const auto start = std::chrono::steady_clock::now();
+
+    messagebus::Message message = sendRequest(
+        bus.bus(), std::move(data), action, bus.clientName(), queueNameDest, agentNameDest,
+        static_cast<int>(timeout.count()));
+
+    m_agentLatency.record(queueNameDest, op,
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start));
+
+    return message;
+}
+
 dto::srr::SaveResponse SrrWorker::saveFeature(
     const dto::srr::FeatureName& featureName, const std::string& passphrase, const std::string& sessionToken)
 {
@@ -92,6 +194,9 @@ dto::srr::SaveResponse SrrWorker::saveFeature(
 
     log_debug("Request save of feature %s to agent %s", featureName.c_str(), agentNameDest.c_str());
 
+    TraceSpan span("feature", "save feature");
+    span.tag("feature", featureName).tag("agent", agentNameDest);
+
     dto::srr::Query saveQuery = dto::srr::createSaveQuery({featureName}, passphrase, sessionToken);
 
     dto::UserData data;
@@ -99,7 +204,7 @@ dto::srr::SaveResponse SrrWorker::saveFeature(
     // Send message to agent
     messagebus::Message message;
     try {
-        message = sendRequest(m_msgBus, data, "save", m_parameters.at(AGENT_NAME_KEY), queueNameDest, agentNameDest);
+        message = sendAgentRequest(AgentOperation::SAVE, std::move(data), "save", queueNameDest, agentNameDest);
     } catch (SrrException& ex) {
         throw(SrrSaveFailed("Request to agent " + agentNameDest + ":" + queueNameDest + " failed: " + ex.what()));
     }
@@ -115,31 +220,45 @@ dto::srr::SaveResponse SrrWorker::saveFeature(
         }
     }
 
-    response = featureResponse.save();
+    response.Swap(featureResponse.mutable_save());
 
     return response;
 }
 
-dto::srr::RestoreResponse SrrWorker::restoreFeature(
-    const dto::srr::FeatureName& featureName, const dto::srr::RestoreQuery& query)
+dto::srr::SaveResponse SrrWorker::saveFeatureShared(
+    const dto::srr::FeatureName& featureName, const std::string& passphrase, const std::string& sessionToken)
+{
+    return m_saveFlights.run(SaveSingleFlight::key(featureName, passphrase, sessionToken), [&]() {
+        return saveFeature(featureName, passphrase, sessionToken);
+    });
+}
+
+dto::srr::RestoreResponse SrrWorker::restoreStep(const PlanStep& step, dto::srr::RestoreQuery query)
 {
-    const std::string agentNameDest = g_srrFeatureMap.at(featureName).m_agent;
-    const std::string queueNameDest = g_agentToQueue.at(agentNameDest);
+    const std::string& agentNameDest = step.m_agent;
+    const std::string  queueNameDest = g_agentToQueue.at(agentNameDest);
+    const std::string  featureNames  = joinNames({step.m_features.begin(), step.m_features.end()});
+
+    TraceSpan span("feature", "restore feature");
+    span.tag("feature", featureNames).tag("agent", agentNameDest);
 
     Query restoreQuery;
-    *(restoreQuery.mutable_restore()) = query;
-    log_debug("Request restore of feature %s to agent %s ", featureName.c_str(), agentNameDest.c_str());
+    restoreQuery.mutable_restore()->Swap(&query);
+    log_debug("Request restore of features %s to agent %s ", featureNames.c_str(), agentNameDest.c_str());
 
     // Send message
     dto::UserData data;
     data << restoreQuery;
     messagebus::Message message;
+    invalidateSavedFeatures(step.m_features);
     try {
-        message = sendRequest(
-            m_msgBus, data, "restore", m_parameters.at(AGENT_NAME_KEY), queueNameDest, agentNameDest, m_sendTimeout);
+        message = sendAgentRequest(AgentOperation::RESTORE, std::move(data), "restore", queueNameDest, agentNameDest);
     } catch (SrrException& ex) {
+        invalidateSavedFeatures(step.m_features);
         throw(SrrRestoreFailed("Request to agent " + agentNameDest + ":" + queueNameDest + " failed: " + ex.what()));
     }
+    // the saves done during the restore are stale too
+    invalidateSavedFeatures(step.m_features);
 
     Response response;
     message.userData() >> response;
@@ -154,112 +273,375 @@ dto::srr::RestoreResponse SrrWorker::restoreFeature(
     }
 
     if (!restoreOk) {
-        throw SrrRestoreFailed("Restore procedure failed for feature " + featureName);
+        throw SrrRestoreFailed("Restore procedure failed for features " + featureNames);
     }
 
-    return response.restore();
+    RestoreResponse restoreResponse;
+    restoreResponse.Swap(response.mutable_restore());
+
+    return restoreResponse;
 }
 
-dto::srr::ResetResponse SrrWorker::resetFeature(const dto::srr::FeatureName& featureName)
+void SrrWorker::invalidateSavedFeatures(const std::vector<FeatureName>& features)
 {
-    const std::string agentNameDest = g_srrFeatureMap.at(featureName).m_agent;
-    const std::string queueNameDest = g_agentToQueue.at(agentNameDest);
+    if (m_saveCache) {
+        for (const auto& featureName : features) {
+            m_saveCache->invalidate(featureName);
+        }
+    }
+}
 
-    log_debug("Request reset of feature %s to agent %s ", featureName.c_str(), agentNameDest.c_str());
+std::map<FeatureName, std::string> SrrWorker::resetFeatures(
+    const std::vector<FeatureName>& features, std::map<FeatureName, uint64_t>& durationsMs)
+{
+    std::map<FeatureName, std::string> errors;
+
+    // features of each agent, in reset order
+    std::map<std::string, std::vector<FeatureName>> agentFeatures;
+    for (const auto& featureName : features) {
+        auto found = g_srrFeatureMap.find(featureName);
+        if (found == g_srrFeatureMap.end()) {
+            errors[featureName] = "Feature " + featureName + " not found";
+        } else if (found->second.m_reset) {
+            agentFeatures[found->second.m_agent].push_back(featureName);
+        }
+    }
+    if (agentFeatures.empty()) {
+        return errors;
+    }
+    invalidateSavedFeatures(features);
+
+    TraceSpan span("phase", "reset agents");
+    span.tag("agents", std::to_string(agentFeatures.size()));
+
+    auto bus = m_busPool.checkout();
+
+    // the queries and responses only live for the reset, they are freed at once with the arena
+    google::protobuf::Arena arena;
+
+    struct AgentReset
+    {
+        std::string                           m_agent;
+        std::vector<FeatureName>              m_features;
+        std::chrono::steady_clock::time_point m_start;
+        std::unique_ptr<PendingRequest>       m_request;
+    };
+    std::vector<AgentReset> resets;
+
+    // one query per agent, all the agents at once
+    for (const auto& entry : agentFeatures) {
+        AgentReset reset;
+        reset.m_agent    = entry.first;
+        reset.m_features = entry.second;
+        reset.m_start    = std::chrono::steady_clock::now();
+
+        Query&      query               = *google::protobuf::Arena::CreateMessage<Query>(&arena);
+        ResetQuery& resetQuery          = *(query.mutable_reset());
+        *(resetQuery.mutable_version()) = m_srrVersion;
+        for (const auto& featureName : entry.second) {
+            resetQuery.add_features(featureName);
+        }
 
-    Query       query;
-    ResetQuery& resetQuery          = *(query.mutable_reset());
-    *(resetQuery.mutable_version()) = m_srrVersion;
-    resetQuery.add_features(featureName);
+        dto::UserData data;
+        data << query;
 
-    dto::UserData data;
-    data << query;
-    messagebus::Message message;
-    try {
-        message = sendRequest(
-            m_msgBus, data, "reset", m_parameters.at(AGENT_NAME_KEY), queueNameDest, agentNameDest, m_sendTimeout);
-    } catch (SrrException& ex) {
-        throw(SrrResetFailed("Request to agent " + agentNameDest + ":" + queueNameDest + " failed: " + ex.what()));
+        log_debug("Request reset of %zu features to agent %s", entry.second.size(), entry.first.c_str());
+        try {
+            const std::string& queueNameDest = g_agentToQueue.at(entry.first);
+            reset.m_request = std::unique_ptr<PendingRequest>(new PendingRequest(sendRequestAsync(bus.bus(),
+                std::move(data), "reset", bus.clientName(), queueNameDest, entry.first,
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    m_agentLatency.timeout(queueNameDest, AgentOperation::RESET)))));
+        } catch (const std::exception& ex) {
+            for (const auto& featureName : entry.second) {
+                errors[featureName] = "Request to agent " + entry.first + " failed: " + ex.what();
+            }
+            continue;
+        }
+        resets.push_back(std::move(reset));
     }
 
-    Response response;
-    message.userData() >> response;
+    for (auto& reset : resets) {
+        try {
+            messagebus::Message message = reset.m_request->get();
 
-    bool resetOk = true;
-    for (const auto& f : response.reset().map_features_status()) {
-        if (f.second.status() != Status::SUCCESS) {
-            resetOk = false;
+            const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+                reset.m_request->receivedAt() - reset.m_start);
+            m_agentLatency.record(reset.m_request->queueName(), AgentOperation::RESET, latency);
+
+            Response& response = *google::protobuf::Arena::CreateMessage<Response>(&arena);
+            message.userData() >> response;
+
+            for (const auto& featureName : reset.m_features) {
+                durationsMs[featureName] = static_cast<uint64_t>(latency.count());
+
+                auto status = response.reset().map_features_status().find(featureName);
+                if (status == response.reset().map_features_status().end()) {
+                    errors[featureName] = "Reset procedure failed for feature " + featureName + ": no status";
+                } else if (status->second.status() != Status::SUCCESS) {
+                    errors[featureName] = "Reset procedure failed for feature " + featureName + ": " +
+                                          status->second.error();
+                }
+            }
+        } catch (const std::exception& ex) {
+            for (const auto& featureName : reset.m_features) {
+                durationsMs[featureName] = msSince(reset.m_start);
+                errors[featureName]      = "Request to agent " + reset.m_agent + " failed: " + ex.what();
+            }
+        }
+    }
+    // the saves done during the reset are stale too
+    invalidateSavedFeatures(features);
+
+    return errors;
+}
+
+std::map<FeatureName, std::string> SrrWorker::restoreFeatures(const std::vector<FeatureName>& features,
+    SaveResponse& data, const std::string& passphrase, std::map<FeatureName, uint64_t>& durationsMs)
+{
+    std::map<FeatureName, std::string> errors;
+
+    // features of each agent
+    std::map<std::string, std::vector<FeatureName>> agentFeatures;
+    for (const auto& featureName : features) {
+        auto found = g_srrFeatureMap.find(featureName);
+        if (found == g_srrFeatureMap.end()) {
+            errors[featureName] = "Feature " + featureName + " not found";
+        } else {
+            agentFeatures[found->second.m_agent].push_back(featureName);
         }
     }
-    if (!resetOk) {
-        throw SrrResetFailed("Reset procedure failed for feature " + featureName);
+    if (agentFeatures.empty()) {
+        return errors;
+    }
+    invalidateSavedFeatures(features);
+
+    TraceSpan span("phase", "restore agents");
+    span.tag("agents", std::to_string(agentFeatures.size()));
+
+    auto bus = m_busPool.checkout();
+
+    // the queries (holding the feature data) and responses only live for the restore, they are freed at once
+    // with the arena
+    google::protobuf::Arena arena;
+
+    struct AgentRestore
+    {
+        std::string                           m_agent;
+        std::vector<FeatureName>              m_features;
+        std::chrono::steady_clock::time_point m_start;
+        std::unique_ptr<PendingRequest>       m_request;
+    };
+    std::vector<AgentRestore> restores;
+
+    // one query per agent, all the agents at once
+    for (const auto& entry : agentFeatures) {
+        AgentRestore restore;
+        restore.m_agent    = entry.first;
+        restore.m_features = entry.second;
+        restore.m_start    = std::chrono::steady_clock::now();
+
+        Query&        query                  = *google::protobuf::Arena::CreateMessage<Query>(&arena);
+        RestoreQuery& restoreQuery           = *(query.mutable_restore());
+        *(restoreQuery.mutable_version())    = m_srrVersion;
+        *(restoreQuery.mutable_checksum())   = fty::encrypt(passphrase, passphrase);
+        *(restoreQuery.mutable_passpharse()) = passphrase;
+        for (const auto& featureName : entry.second) {
+            moveFeature((*restoreQuery.mutable_map_features_data())[featureName],
+                *data.mutable_map_features_data()->at(featureName).mutable_feature());
+        }
+
+        dto::UserData userData;
+        userData << query;
+
+        log_debug("Request restore of %zu features to agent %s", entry.second.size(), entry.first.c_str());
+        try {
+            const std::string& queueNameDest = g_agentToQueue.at(entry.first);
+            restore.m_request = std::unique_ptr<PendingRequest>(new PendingRequest(sendRequestAsync(bus.bus(),
+                std::move(userData), "restore", bus.clientName(), queueNameDest, entry.first,
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    m_agentLatency.timeout(queueNameDest, AgentOperation::RESTORE)))));
+        } catch (const std::exception& ex) {
+            for (const auto& featureName : entry.second) {
+                errors[featureName] = "Request to agent " + entry.first + " failed: " + ex.what();
+            }
+            continue;
+        }
+        restores.push_back(std::move(restore));
+    }
+
+    for (auto& restore : restores) {
+        try {
+            messagebus::Message message = restore.m_request->get();
+
+            const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+                restore.m_request->receivedAt() - restore.m_start);
+            m_agentLatency.record(restore.m_request->queueName(), AgentOperation::RESTORE, latency);
+
+            Response& response = *google::protobuf::Arena::CreateMessage<Response>(&arena);
+            message.userData() >> response;
+
+            for (const auto& featureName : restore.m_features) {
+                durationsMs[featureName] += static_cast<uint64_t>(latency.count());
+
+                auto status = response.restore().map_features_status().find(featureName);
+                if (status == response.restore().map_features_status().end()) {
+                    errors[featureName] = "Restore procedure failed for feature " + featureName + ": no status";
+                } else if (status->second.status() != Status::SUCCESS) {
+                    errors[featureName] = "Restore procedure failed for feature " + featureName + ": " +
+                                          status->second.error();
+                }
+            }
+        } catch (const std::exception& ex) {
+            for (const auto& featureName : restore.m_features) {
+                durationsMs[featureName] += msSince(restore.m_start);
+                errors[featureName] = "Request to agent " + restore.m_agent + " failed: " + ex.what();
+            }
+        }
     }
+    // the saves done during the restore are stale too
+    invalidateSavedFeatures(features);
 
-    return response.reset();
+    return errors;
 }
 
-bool SrrWorker::rollback(const dto::srr::SaveResponse& rollbackSaveResponse, const std::string& passphrase)
+bool SrrWorker::rollback(dto::srr::SaveResponse& rollbackSaveResponse, const std::string& passphrase,
+    std::map<FeatureName, uint64_t>& durationsMs, std::map<FeatureName, uint64_t>& settleMs)
 {
     bool restart = false;
 
     log_debug("Starting features roll back...");
 
-    std::map<std::string, FeatureAndStatus> rollbackMap(
-        rollbackSaveResponse.map_features_data().begin(), rollbackSaveResponse.map_features_data().end());
+    TraceSpan span("phase", "rollback");
+    Metrics::instance().rollback();
 
     std::vector<FeatureName> featuresToRestore;
 
-    for (const auto& entry : rollbackMap) {
+    for (const auto& entry : rollbackSaveResponse.map_features_data()) {
         featuresToRestore.push_back(entry.first);
     }
 
     // in version 1.0 sorting has no practical effect, as there is no concept of groups
     // in version 2.0, a rollbackSaveResponse will contain only features from the same group -> ordering is meaningful
-    std::sort(featuresToRestore.begin(), featuresToRestore.end(), [&](FeatureName l, FeatureName r) {
+    std::sort(featuresToRestore.begin(), featuresToRestore.end(), [&](const FeatureName& l, const FeatureName& r) {
         return getPriority(l) < getPriority(r);
     });
 
-    // reset features in reverse order
-    for (auto revIt = featuresToRestore.rbegin(); revIt != featuresToRestore.rend(); revIt++) {
-        if (g_srrFeatureMap.at(*revIt).m_reset) {
-            try {
-                resetFeature(*revIt);
-            } catch (SrrResetFailed& ex) {
-                log_warning(ex.what());
+    // reset features in reverse order, the agents concurrently
+    std::map<FeatureName, uint64_t> resetDurations;
+    for (const auto& error :
+        resetFeatures(std::vector<FeatureName>(featuresToRestore.rbegin(), featuresToRestore.rend()), resetDurations)) {
+        log_warning(error.second.c_str());
+    }
+    for (const auto& duration : resetDurations) {
+        durationsMs[duration.first] += duration.second;
+    }
+
+    // restore the features of a same priority together, the agents concurrently
+    // a priority level only starts once the previous one had time to settle
+    for (auto levelBegin = featuresToRestore.begin(); levelBegin != featuresToRestore.end();) {
+        const unsigned priority = getPriority(*levelBegin);
+        const auto     levelEnd = std::find_if(levelBegin, featuresToRestore.end(), [&](const FeatureName& name) {
+            return getPriority(name) != priority;
+        });
+        const std::vector<FeatureName> level(levelBegin, levelEnd);
+        levelBegin = levelEnd;
+
+        log_debug("Rollback of %zu features with priority %u", level.size(), priority);
+        for (const auto& error : restoreFeatures(level, rollbackSaveResponse, passphrase, durationsMs)) {
+            log_error("Feature %s is unrecoverable. May be in undefined state: %s", error.first.c_str(),
+                error.second.c_str());
+        }
+
+        for (const auto& featureName : level) {
+            auto found = g_srrFeatureMap.find(featureName);
+            if (found != g_srrFeatureMap.end()) {
+                restart = restart | found->second.m_restart;
             }
         }
+
+        // wait to sync features restore
+        // the agents answer a query right away, nothing tells when they are done applying a restore
+        TraceSpan  settleSpan("phase", "settle");
+        const auto settleStart = m_clock.now();
+        m_clock.sleepFor(std::chrono::seconds(FEATURE_RESTORE_DELAY_SEC));
+        for (const auto& featureName : level) {
+            settleMs[featureName] += durationMs(settleStart, m_clock.now());
+        }
     }
 
-    for (const auto& featureName : featuresToRestore) {
-        const dto::srr::Feature& featureData = rollbackMap.at(featureName).feature();
+    log_debug("Roll back completed");
 
-        const std::string agentNameDest = g_srrFeatureMap.at(featureName).m_agent;
-        const std::string queueNameDest = g_agentToQueue.at(agentNameDest);
+    return restart;
+}
 
-        // Build restore query
-        RestoreQuery restoreQuery;
+std::set<std::string> SrrWorker::findUnresponsiveAgents(const std::set<std::string>& agents)
+{
+    if (m_preflightMode == PREFLIGHT_OFF || agents.empty()) {
+        return {};
+    }
 
-        *(restoreQuery.mutable_version())    = m_srrVersion;
-        *(restoreQuery.mutable_checksum())   = fty::encrypt(passphrase, passphrase);
-        *(restoreQuery.mutable_passpharse()) = passphrase;
-        restoreQuery.mutable_map_features_data()->insert({featureName, featureData});
+    TraceSpan span("phase", "preflight");
+    span.tag("agents", joinNames(agents));
 
-        // restore backup data
-        log_debug("Rollback configuration of %s by agent %s ", featureName.c_str(), agentNameDest.c_str());
+    return pingAgents(agents, m_preflightTimeout);
+}
+
+std::set<std::string> SrrWorker::pingAgents(const std::set<std::string>& agents, std::chrono::milliseconds timeout)
+{
+    std::set<std::string> unresponsive;
+
+    // an empty save query would save every feature of the agent, the ping only asks for an unknown one
+    dto::UserData data;
+    data << dto::srr::createSaveQuery({F_PING}, "", "");
+
+    auto bus = m_busPool.checkout();
+
+    std::vector<PendingRequest> pings;
+    for (const auto& agentName : agents) {
         try {
-            restoreFeature(featureName, restoreQuery);
-        } catch (SrrRestoreFailed& ex) {
-            log_error("Feature %s is unrecoverable. May be in undefined state", featureName.c_str());
+            pings.push_back(sendRequestAsync(
+                bus.bus(), data, "save", bus.clientName(), g_agentToQueue.at(agentName), agentName, timeout));
+        } catch (const std::exception& ex) {
+            log_error("Ping of agent %s failed: %s", agentName.c_str(), ex.what());
+            unresponsive.insert(agentName);
         }
-        log_debug("%s rolled back by: %s ", featureName.c_str(), agentNameDest.c_str());
-        restart = restart | g_srrFeatureMap.at(featureName).m_restart;
-        // wait to sync feature restore
-        std::this_thread::sleep_for(std::chrono::seconds(FEATURE_RESTORE_DELAY_SEC));
     }
 
-    log_debug("Roll back completed");
+    // all the pings share the same deadline
+    for (auto& ping : pings) {
+        try {
+            ping.get();
+        } catch (const std::exception& ex) {
+            log_error("Agent %s is not responding", ping.agentName().c_str());
+            unresponsive.insert(ping.agentName());
+        }
+    }
 
-    return restart;
+    return unresponsive;
+}
+
+std::set<std::string> SrrWorker::checkAgentsBeforeRestore(const std::set<std::string>& agents)
+{
+    std::set<std::string> unresponsive = findUnresponsiveAgents(agents);
+
+    if (!unresponsive.empty() && m_preflightMode == PREFLIGHT_REFUSE) {
+        throw std::runtime_error("Restore not started, agents not responding: " + joinNames(unresponsive));
+    }
+    return unresponsive;
+}
+
+static std::set<std::string> getGroupAgents(const std::string& groupId)
+{
+    std::set<std::string> agents;
+
+    auto found = g_srrGroupMap.find(groupId);
+    if (found != g_srrGroupMap.end()) {
+        for (const auto& fp : found->second.m_fp) {
+            agents.insert(g_srrFeatureMap.at(fp.m_feature).m_agent);
+        }
+    }
+    return agents;
 }
 
 // UI interface
@@ -311,26 +693,54 @@ dto::UserData SrrWorker::requestSave(const std::string& json)
 
     log_debug("SRR save request");
 
+    const int64_t traceStart = Tracer::nowUs();
+    TraceSpan     operationSpan("operation", "save");
+
     srrSaveResp.m_version = m_srrVersion;
     srrSaveResp.m_status  = statusToString(Status::FAILED);
 
     bool allGroupsSaved = true;
 
     try {
-        cxxtools::SerializationInfo requestSi = dto::srr::deserializeJson(json);
-        SrrSaveRequest              srrSaveReq;
+        TraceSpan parseSpan("phase", "parse");
+
+        SrrSaveRequest srrSaveReq;
+        if (auto ret = pack::json::deserialize(json, srrSaveReq); !ret) {
+            throw std::runtime_error(ret.error());
+        }
+        parseSpan.end();
 
-        requestSi >>= srrSaveReq;
+        const std::string& passphrase   = srrSaveReq.m_passphrase.value();
+        const std::string& sessionToken = srrSaveReq.m_sessionToken.value();
 
         // check that passphrase is compliant with requested format
-        if (srr::checkPassphraseFormat(srrSaveReq.m_passphrase)) {
+        if (srr::checkPassphraseFormat(passphrase)) {
             // evalutate checksum
-            srrSaveResp.m_checksum = fty::encrypt(srrSaveReq.m_passphrase, srrSaveReq.m_passphrase);
+            srrSaveResp.m_checksum = fty::encrypt(passphrase, passphrase);
 
             log_debug("Save IPM2 configuration processing");
 
+            // delta save: hashes of the features of the base
+            std::map<std::string, std::string> baseHashes = srrSaveReq.m_base_features.value();
+            if (!srrSaveReq.m_base_snapshot_id.value().empty()) {
+                if (!m_snapshotStore) {
+                    throw std::runtime_error("Snapshots are not enabled");
+                }
+                baseHashes = evalFeatureHashes(m_snapshotStore->manifest(srrSaveReq.m_base_snapshot_id.value()));
+                srrSaveResp.m_base_snapshot_id = srrSaveReq.m_base_snapshot_id.value();
+            }
+
             std::map<std::string, Group> savedGroups;
 
+            // check that all the involved agents are alive before calling them one by one
+            std::set<std::string> requiredAgents;
+            for (const auto& groupId : srrSaveReq.m_group_list) {
+                const auto groupAgents = getGroupAgents(groupId);
+                requiredAgents.insert(groupAgents.begin(), groupAgents.end());
+            }
+            const std::set<std::string> unresponsiveAgents = findUnresponsiveAgents(requiredAgents);
+            std::set<std::string>       skippedGroups;
+
             // save all the features for each required group
             for (const auto& groupId : srrSaveReq.m_group_list) {
                 log_debug("Saving features from group %s ", groupId.c_str());
@@ -345,23 +755,56 @@ dto::UserData SrrWorker::requestSave(const std::string& json)
                     continue;
                 }
 
+                const auto groupAgents = getGroupAgents(groupId);
+                if (std::any_of(groupAgents.begin(), groupAgents.end(), [&](const std::string& agent) {
+                        return unresponsiveAgents.count(agent) != 0;
+                    })) {
+                    allGroupsSaved = false;
+                    skippedGroups.insert(groupId);
+                    log_error("Group %s not saved: agent not responding", groupId.c_str());
+                    continue;
+                }
+
+                TraceSpan groupSpan("group", "save group");
+                groupSpan.tag("group", groupId);
+
+                Timings groupTimings;
+                groupTimings.m_name = groupId;
+
                 try {
                     for (const auto& entry : group.m_fp) {
                         const auto& featureName = entry.m_feature;
 
-                        SaveResponse saveResp =
-                            saveFeature(featureName, srrSaveReq.m_passphrase, srrSaveReq.m_sessionToken);
-                        // convert ProtoBuf save response to UI DTO
-                        const auto& mapFeaturesData = saveResp.map_features_data();
+                        Timings featureTimings;
+                        featureTimings.m_name = featureName;
 
-                        for (const auto& fs : mapFeaturesData) {
+                        const auto   start = std::chrono::steady_clock::now();
+                        SaveResponse saveResp;
+                        if (!m_saveCache || !m_saveCache->get(featureName, passphrase, sessionToken, saveResp)) {
+                            // a change during the agent call makes the saved data unfit for the cache
+                            const unsigned long generation = m_saveCache ? m_saveCache->generation(featureName) : 0;
+
+                            saveResp = saveFeatureShared(featureName, passphrase, sessionToken);
+                            if (m_saveCache) {
+                                m_saveCache->put(featureName, passphrase, sessionToken, saveResp, generation);
+                            }
+                        }
+                        featureTimings.m_save_ms = msSince(start);
+
+                        // convert ProtoBuf save response to UI DTO, the data is moved, not copied
+                        for (auto& fs : *saveResp.mutable_map_features_data()) {
                             SrrFeature f;
-                            f.m_feature_name       = fs.first;
-                            f.m_feature_and_status = fs.second;
+                            f.m_feature_name = fs.first;
+                            f.m_feature_and_status.Swap(&fs.second);
+
+                            featureTimings.m_payload_bytes += f.m_feature_and_status.feature().data().size();
 
                             // save each feature into its group
-                            savedGroups[groupId].m_features.push_back(f);
+                            savedGroups[groupId].m_features.push_back(std::move(f));
                         }
+
+                        groupTimings += featureTimings;
+                        groupTimings.m_features.push_back(featureTimings);
                     }
                 } catch (std::exception& e) {
                     allGroupsSaved = false;
@@ -369,12 +812,14 @@ dto::UserData SrrWorker::requestSave(const std::string& json)
                         e.what());
                     // delete the current group, as it would be incomplete
                     savedGroups.erase(groupId);
+                    srrSaveResp.m_timings.push_back(groupTimings);
                     continue;
                 }
+                srrSaveResp.m_timings.push_back(groupTimings);
             }
 
             // update group info and evaluate data integrity
-            for (auto groupElement : savedGroups) {
+            for (auto& groupElement : savedGroups) {
                 const auto& groupId = groupElement.first;
                 auto&       group   = groupElement.second;
 
@@ -382,9 +827,12 @@ dto::UserData SrrWorker::requestSave(const std::string& json)
                 group.m_group_name = groupId;
 
                 // evaluate data integrity
+                TraceSpan integritySpan("phase", "integrity");
+                integritySpan.tag("group", groupId);
                 evalDataIntegrity(group);
+                integritySpan.end();
 
-                srrSaveResp.m_data.push_back(group);
+                srrSaveResp.m_data.push_back(std::move(group));
             }
 
             if (allGroupsSaved) {
@@ -392,6 +840,39 @@ dto::UserData SrrWorker::requestSave(const std::string& json)
             } else {
                 srrSaveResp.m_status = statusToString(Status::PARTIAL_SUCCESS);
             }
+
+            if (!unresponsiveAgents.empty()) {
+                srrSaveResp.m_error = TRANSLATE_ME("Agents not responding: %s. Groups not saved: %s",
+                    joinNames(unresponsiveAgents).c_str(), joinNames(skippedGroups).c_str());
+            }
+
+            // keep a local copy, a failure must not make the save fail
+            if (m_snapshotStore && !srrSaveResp.m_data.empty()) {
+                TraceSpan snapshotSpan("phase", "snapshot");
+                try {
+                    srrSaveResp.m_snapshot_id = m_snapshotStore->store(srrSaveResp).m_id;
+                } catch (const std::exception& e) {
+                    log_error("Failed to store the snapshot of the save: %s", e.what());
+                }
+            }
+
+            // the data integrity is evaluated on the full data, which is rebuilt on restore
+            if (!baseHashes.empty()) {
+                TraceSpan deltaSpan("phase", "delta");
+
+                size_t unchanged = 0;
+                for (auto& group : srrSaveResp.m_data) {
+                    for (auto& feature : group.m_features) {
+                        auto found = baseHashes.find(feature.m_feature_name);
+                        if (found != baseHashes.end() && found->second == evalFeatureHash(feature)) {
+                            feature.m_ref = found->second;
+                            feature.m_feature_and_status.mutable_feature()->clear_data();
+                            unchanged++;
+                        }
+                    }
+                }
+                log_info("Delta save: %zu unchanged features not included in the payload", unchanged);
+            }
         } else {
             srrSaveResp.m_error =
                 TRANSLATE_ME("Passphrase must have %s characters", (fty::getPassphraseFormat()).c_str());
@@ -408,178 +889,417 @@ dto::UserData SrrWorker::requestSave(const std::string& json)
     cxxtools::SerializationInfo responseSi;
     responseSi <<= srrSaveResp;
 
-    std::string jsonResp = serializeJson(responseSi);
-
     response.push_back(srrSaveResp.m_status);
-    response.push_back(jsonResp);
+    response.push_back(serializeJson(responseSi));
+
+    operationSpan.end();
+    exportTrace("save", traceStart);
 
     return response;
 }
 
-static std::string zmsg_popstring(zmsg_t* resp)
+// group of a restore, validated and backed up, ready to be reset and restored
+struct PreparedRestoreGroup
 {
-    char* popstr = zmsg_popstr(resp);
-    // copies the null-terminated character sequence (C-string) pointed by popstr
-    std::string string_rv = popstr;
-    zstr_free(&popstr);
-    return string_rv;
-}
-
-static bool getLicenseCapabilities()
+    bool                                m_valid = false;
+    RestoreStatus                       m_status; // why the group is skipped, if not valid
+    std::map<FeatureName, RestoreQuery> m_queries;
+    SaveResponse                        m_backup; // current state of the group, for the rollback
+    Timings                             m_timings;
+};
+
+bool SrrWorker::executeRestorePlan(
+    const RestorePlan& plan, const SrrRestoreRequest& srrRestoreReq, SrrRestoreResponse& srrRestoreResp)
 {
-    MlmClientPool::Ptr client = mlm_pool.get();
-    if (!client.getPointer()) {
-        log_error("fty-srr: mlm_pool.get () failed.");
-        return false;
-    }
+    bool restart = false;
 
-    zmsg_t* req = zmsg_new();
-    zmsg_addstr(req, "CAPABILITIES");
-    zmsg_addstr(req, "configurability");
+    std::shared_ptr<SrrRestoreRequestDataV2> dataPtr =
+        std::dynamic_pointer_cast<SrrRestoreRequestDataV2>(srrRestoreReq.m_data_ptr);
 
-    zmsg_t* resp = client->requestreply("etn-licensing", "licensing", 5, &req);
-    if (!resp) {
-        log_error("fty-srr: client->requestreply (timeout = '5') returned NULL");
-        return false;
+    std::map<std::string, Group*> groupData;
+    for (auto& group : dataPtr->m_data) {
+        groupData.emplace(group.m_group_id, &group);
     }
 
-    std::string command = zmsg_popstring(resp);
-    if (command != "CAPABILITIES") {
-        zmsg_destroy(&resp);
-        log_debug("fty-srr: Unknown command received");
-        return false;
-    }
+    // the groups go through a pipeline: the validation and the backup of the next group run in the
+    // background while the current group is reset, restored and settled, unless the backup involves an
+    // agent of the current group: it then waits for the group to settle. The destructive stages (reset,
+    // restore) stay strictly sequential, in restore order.
+    RestoreResponse response;
+    bool            allGroupsRestored = true;
 
-    std::string code = zmsg_popstring(resp);
-    if (code != "OK") {
-        zmsg_destroy(&resp);
-        log_debug("fty-srr: %", code.c_str());
-        return false;
-    }
+    auto prepareGroup = [&](const GroupPlan& groupPlan) -> PreparedRestoreGroup {
+        const auto& groupId = groupPlan.m_group_id;
 
-    std::string configurabilityStr = zmsg_popstring(resp);
-    zmsg_destroy(&resp);
+        PreparedRestoreGroup prepared;
+        prepared.m_status.m_name   = groupId;
+        prepared.m_status.m_status = statusToString(Status::FAILED);
 
-    bool configurability;
+        if (!groupPlan.m_error.empty()) {
+            prepared.m_status.m_error = groupPlan.m_error;
+            return prepared;
+        }
 
-    std::istringstream(configurabilityStr) >> configurability;
+        TraceSpan validateSpan("phase", "validate");
+        validateSpan.tag("group", groupId);
 
-    return configurability;
-}
+        std::map<std::string, dto::srr::FeatureAndStatus*> ftMap;
+        for (auto& feature : groupData.at(groupId)->m_features) {
+            ftMap[feature.m_feature_name] = &feature.m_feature_and_status;
+        }
 
-dto::UserData SrrWorker::requestRestore(const std::string& json, bool force)
-{
-    bool restart = false;
+        prepared.m_timings.m_name = groupId;
+        for (const auto& step : groupPlan.m_backup) {
+            for (const auto& featureName : step.m_features) {
+                Timings featureTimings;
+                featureTimings.m_name = featureName;
+                if (ftMap.count(featureName)) {
+                    featureTimings.m_payload_bytes = ftMap.at(featureName)->feature().data().size();
+                }
+                prepared.m_timings.m_features.push_back(featureTimings);
+            }
+        }
 
-    log_debug("SRR restore request");
+        // create all restore queries related to the current group, one per step, the data is moved into them
+        for (const auto& step : groupPlan.m_restore) {
+            RestoreQuery& request = prepared.m_queries[step.m_features.front()];
+            request.set_passpharse(srrRestoreReq.m_passphrase);
+            request.set_session_token(srrRestoreReq.m_sessionToken);
+            for (const auto& featureName : step.m_features) {
+                moveFeature((*request.mutable_map_features_data())[featureName],
+                    *ftMap.at(featureName)->mutable_feature());
+            }
+        }
+        validateSpan.end();
+
+        // save group status to perform a rollback in case of error, a group which can't be rolled back is skipped
+        TraceSpan backupSpan("phase", "backup");
+        backupSpan.tag("group", groupId);
+        for (auto& timings : prepared.m_timings.m_features) {
+            log_debug("Saving feature %s current status", timings.m_name.c_str());
+            const auto start = std::chrono::steady_clock::now();
+            try {
+                mergeResponse(prepared.m_backup,
+                    saveFeature(timings.m_name, srrRestoreReq.m_passphrase, srrRestoreReq.m_sessionToken));
+            } catch (std::exception& ex) {
+                prepared.m_status.m_error =
+                    TRANSLATE_ME("Could not backup feature %s. Restore will be skipped", timings.m_name.c_str());
+                log_error("%s: %s", prepared.m_status.m_error.c_str(), ex.what());
+                return prepared;
+            }
+            timings.m_backup_ms = msSince(start);
+        }
 
-    SrrRestoreResponse srrRestoreResp;
+        prepared.m_valid = true;
+        return prepared;
+    };
 
-    srrRestoreResp.m_status = statusToString(Status::FAILED);
+    std::future<PreparedRestoreGroup> nextGroup;
+    if (!plan.m_groups.empty()) {
+        nextGroup = std::async(std::launch::async, prepareGroup, std::cref(plan.m_groups.front()));
+    }
 
-    try {
-        if (!getLicenseCapabilities()) {
-            log_error("Restore not allowed by licensing limitations");
-            throw std::runtime_error("Restore not allowed by licensing limitations");
+    for (size_t i = 0; i < plan.m_groups.size(); i++) {
+        const auto& groupPlan = plan.m_groups[i];
+        const auto& groupId   = groupPlan.m_group_id;
+
+        PreparedRestoreGroup prepared = nextGroup.get();
+
+        // prepare the next group while this one is restored, or once it is done with its agents
+        if (i + 1 < plan.m_groups.size()) {
+            const auto policy =
+                canOverlapBackup(groupPlan, plan.m_groups[i + 1]) ? std::launch::async : std::launch::deferred;
+            nextGroup = std::async(policy, prepareGroup, std::cref(plan.m_groups[i + 1]));
         }
 
-        cxxtools::SerializationInfo requestSi = dto::srr::deserializeJson(json);
-        SrrRestoreRequest           srrRestoreReq;
+        if (!prepared.m_valid) {
+            srrRestoreResp.m_status_list.push_back(prepared.m_status);
 
-        requestSi >>= srrRestoreReq;
+            log_error(prepared.m_status.m_error.c_str());
 
-        std::string passphrase = fty::decrypt(srrRestoreReq.m_checksum, srrRestoreReq.m_passphrase);
+            allGroupsRestored = false;
+            continue;
+        }
 
-        if (passphrase.compare(srrRestoreReq.m_passphrase) != 0) {
-            throw std::runtime_error("Invalid passphrase");
+        TraceSpan groupSpan("group", "restore group");
+        groupSpan.tag("group", groupId);
+
+        Timings& groupTimings   = prepared.m_timings;
+        auto     featureTimings = [&](const std::string& featureName) -> Timings& {
+            auto found = std::find_if(groupTimings.m_features.begin(), groupTimings.m_features.end(),
+                [&](const Timings& timings) {
+                    return timings.m_name == featureName;
+                });
+            if (found == groupTimings.m_features.end()) {
+                groupTimings.m_features.emplace_back();
+                groupTimings.m_features.back().m_name = featureName;
+                return groupTimings.m_features.back();
+            }
+            return *found;
+        };
+
+        // reset features in reverse order before restore, the agents of the group concurrently
+        // WARNING: currently reset is not implemented by all features, hence it will not be mandatory
+        TraceSpan                resetSpan("phase", "reset");
+        std::vector<FeatureName> featuresToReset;
+        for (const auto& step : groupPlan.m_reset) {
+            featuresToReset.insert(featuresToReset.end(), step.m_features.begin(), step.m_features.end());
         }
+        std::map<FeatureName, uint64_t> resetDurations;
+        for (const auto& error : resetFeatures(featuresToReset, resetDurations)) {
+            log_warning(error.second.c_str());
+        }
+        for (const auto& duration : resetDurations) {
+            featureTimings(duration.first).m_reset_ms = duration.second;
+        }
+        resetSpan.end();
 
-        if (srrRestoreReq.m_version == "1.0") {
-            const auto& features = srrRestoreReq.m_data_ptr->getSrrFeatures();
+        bool restoreFailed = false;
 
-            bool allFeaturesRestored = true;
+        RestoreStatus restoreStatus;
+        restoreStatus.m_name   = groupId;
+        restoreStatus.m_status = statusToString(Status::SUCCESS);
 
-            std::string featureName;
+        // restore features in order, the features of a step with one query
+        for (const auto& step : groupPlan.m_restore) {
+            const std::string featureNames = joinNames({step.m_features.begin(), step.m_features.end()});
 
-            for (const auto& feature : features) {
-                featureName            = feature.m_feature_name;
-                const auto& dtoFeature = feature.m_feature_and_status.feature();
-                // prepare restore query
-                RestoreQuery query;
-                query.set_passpharse(srrRestoreReq.m_passphrase);
-                query.set_session_token(srrRestoreReq.m_sessionToken);
-                query.mutable_map_features_data()->insert({featureName, dtoFeature});
+            const auto start = std::chrono::steady_clock::now();
+            try {
+                // Restore feature
+                mergeResponse(response, restoreStep(step, std::move(prepared.m_queries.at(step.m_features.front()))));
+                for (const auto& featureName : step.m_features) {
+                    featureTimings(featureName).m_restore_ms = msSince(start);
 
-                RestoreStatus restoreStatus;
-                restoreStatus.m_name = featureName;
+                    // update restart flag
+                    restart = restart | g_srrFeatureMap.at(featureName).m_restart;
+                }
+            } catch (const std::exception& ex) {
+                // restore failed -> rolling back the whole group
+                for (const auto& featureName : step.m_features) {
+                    featureTimings(featureName).m_restore_ms = msSince(start);
+                }
+                restoreFailed = true;
 
-                // save feature to perform a rollback in case of error
-                SaveResponse rollbackSaveResponse;
-                log_debug("Saving feature %s current status", feature.m_feature_name.c_str());
-                try {
-                    rollbackSaveResponse +=
-                        saveFeature(feature.m_feature_name, srrRestoreReq.m_passphrase, srrRestoreReq.m_sessionToken);
-                } catch (std::exception& ex) {
-                    allFeaturesRestored = false;
+                restoreStatus.m_status = statusToString(Status::FAILED);
+                restoreStatus.m_error =
+                    TRANSLATE_ME("Restore failed for feature %s: ", featureNames.c_str(), ex.what());
 
-                    restoreStatus.m_status = statusToString(Status::FAILED);
-                    restoreStatus.m_error =
-                        TRANSLATE_ME("Could not backup feature %s. Restore will be skipped", featureName.c_str());
+                allGroupsRestored = false;
+                log_error(restoreStatus.m_error.c_str());
 
-                    log_error(restoreStatus.m_error.c_str());
+                // stop group restore
+                break;
+            }
 
-                    srrRestoreResp.m_status_list.push_back(restoreStatus);
+            // wait to sync feature restore
+            TraceSpan  settleSpan("phase", "settle");
+            const auto settleStart = m_clock.now();
+            settleSpan.tag("feature", featureNames);
+            m_clock.sleepFor(std::chrono::seconds(FEATURE_RESTORE_DELAY_SEC));
+            for (const auto& featureName : step.m_features) {
+                featureTimings(featureName).m_settle_ms = durationMs(settleStart, m_clock.now());
+            }
+        }
 
-                    continue;
-                }
+        // if restore failed -> rollback
+        uint64_t rollbackMs = 0;
+        if (restoreFailed) {
+            std::map<FeatureName, uint64_t> rollbackDurations;
+            std::map<FeatureName, uint64_t> rollbackSettles;
+            const auto                      start = std::chrono::steady_clock::now();
+            restart =
+                restart | rollback(prepared.m_backup, srrRestoreReq.m_passphrase, rollbackDurations, rollbackSettles);
+            rollbackMs = msSince(start);
+            for (const auto& duration : rollbackDurations) {
+                featureTimings(duration.first).m_rollback_ms = duration.second;
+            }
+            for (const auto& settle : rollbackSettles) {
+                featureTimings(settle.first).m_settle_ms += settle.second;
+            }
+        }
 
-                // reset feature before restore (do not stop on fail -> reset is not supported by every feature yet)
-                if (g_srrFeatureMap.at(featureName).m_reset) {
-                    try {
-                        resetFeature(featureName);
-                    } catch (SrrResetFailed& ex) {
-                        log_warning(ex.what());
-                    }
-                }
+        for (const auto& timings : groupTimings.m_features) {
+            groupTimings += timings;
+        }
+        // the features are rolled back concurrently, the group reports the elapsed time
+        if (restoreFailed) {
+            groupTimings.m_rollback_ms = rollbackMs;
+        }
+        srrRestoreResp.m_timings.push_back(groupTimings);
 
-                // perform restore
-                try {
-                    RestoreResponse resp   = restoreFeature(featureName, query);
-                    restoreStatus.m_status = statusToString(resp.status().status());
-                    restoreStatus.m_error  = TRANSLATE_ME(resp.status().error().c_str());
-                } catch (SrrRestoreFailed& ex) {
-                    allFeaturesRestored = false;
+        // push group status into restore response
+        srrRestoreResp.m_status_list.push_back(restoreStatus);
+    }
 
-                    restoreStatus.m_status = statusToString(Status::FAILED);
-                    restoreStatus.m_error  = TRANSLATE_ME(ex.what());
+    if (allGroupsRestored) {
+        srrRestoreResp.m_status = statusToString(Status::SUCCESS);
+    } else {
+        srrRestoreResp.m_status = statusToString(Status::PARTIAL_SUCCESS);
+    }
+
+    return restart;
+}
 
-                    log_error(restoreStatus.m_error.c_str());
+// convert a v1.0 restore request into groups, the selection being restricted to its features
+static RestoreSelection upgradeV1Payload(
+    SrrRestoreRequest& request, const RestoreSelection& selection, std::vector<RestoreStatus>& statusList)
+{
+    auto                     upgraded = std::make_shared<SrrRestoreRequestDataV2>();
+    std::vector<std::string> features;
+
+    for (const auto& feature : request.m_data_ptr->getSrrFeatures()) {
+        const auto&       featureName = feature.m_feature_name;
+        const std::string groupId     = getGroupFromFeature(featureName);
+        if (groupId.empty()) {
+            RestoreStatus restoreStatus;
+            restoreStatus.m_name   = featureName;
+            restoreStatus.m_status = statusToString(Status::FAILED);
+            restoreStatus.m_error =
+                TRANSLATE_ME("Feature %s is not supported. Will not be restored", featureName.c_str());
+
+            log_error(restoreStatus.m_error.c_str());
+
+            statusList.push_back(restoreStatus);
+            continue;
+        }
+        if (!selection.isSelected(groupId, featureName)) {
+            continue;
+        }
 
-                    srrRestoreResp.m_status_list.push_back(restoreStatus);
+        auto found = std::find_if(upgraded->m_data.begin(), upgraded->m_data.end(), [&](const Group& group) {
+            return group.m_group_id == groupId;
+        });
+        if (found == upgraded->m_data.end()) {
+            upgraded->m_data.emplace_back();
+            upgraded->m_data.back().m_group_id = groupId;
+            found                              = upgraded->m_data.end() - 1;
+        }
+        found->m_features.push_back(feature);
+        features.push_back(featureName);
+    }
 
-                    // start rollback
-                    restart = restart | rollback(rollbackSaveResponse, srrRestoreReq.m_passphrase);
+    if (features.empty()) {
+        throw std::runtime_error("No feature of the payload can be restored");
+    }
 
-                    continue;
-                }
+    request.m_data_ptr = upgraded;
+    // the other features of the groups are left untouched
+    return RestoreSelection(features, {});
+}
 
-                srrRestoreResp.m_status_list.push_back(restoreStatus);
-                // wait to sync feature restore
-                std::this_thread::sleep_for(std::chrono::seconds(FEATURE_RESTORE_DELAY_SEC));
+// give the status and the timings of a restore per feature, as in version 1.0
+static void toV1Response(SrrRestoreResponse& response, const std::vector<SrrFeature>& features)
+{
+    std::vector<RestoreStatus> statusList;
+    for (const auto& status : response.m_status_list) {
+        if (g_srrGroupMap.find(status.m_name) == g_srrGroupMap.end()) {
+            // already a feature status
+            statusList.push_back(status);
+            continue;
+        }
+        for (const auto& feature : features) {
+            if (getGroupFromFeature(feature.m_feature_name) == status.m_name) {
+                RestoreStatus featureStatus = status;
+                featureStatus.m_name        = feature.m_feature_name;
+                statusList.push_back(featureStatus);
             }
-
-            if (allFeaturesRestored) {
-                srrRestoreResp.m_status = statusToString(Status::SUCCESS);
-            } else {
-                srrRestoreResp.m_status = statusToString(Status::PARTIAL_SUCCESS);
+        }
+    }
+    response.m_status_list = statusList;
+
+    std::vector<Timings> timings;
+    for (const auto& group : response.m_timings) {
+        for (const auto& featureTimings : group.m_features) {
+            if (std::any_of(features.begin(), features.end(), [&](const SrrFeature& feature) {
+                    return feature.m_feature_name == featureTimings.m_name;
+                })) {
+                timings.push_back(featureTimings);
             }
-        } else if (srrRestoreReq.m_version == "2.0" || srrRestoreReq.m_version == "2.1") {
+        }
+    }
+    response.m_timings = timings;
+
+    if (response.m_status == statusToString(Status::SUCCESS) &&
+        std::any_of(statusList.begin(), statusList.end(), [](const RestoreStatus& status) {
+            return status.m_status != statusToString(Status::SUCCESS);
+        })) {
+        response.m_status = statusToString(Status::PARTIAL_SUCCESS);
+    }
+}
+
+dto::UserData SrrWorker::requestRestore(const std::string& json, bool force)
+{
+    bool restart = false;
+
+    log_debug("SRR restore request");
+
+    const int64_t traceStart = Tracer::nowUs();
+    TraceSpan     operationSpan("operation", "restore");
+
+    SrrRestoreResponse srrRestoreResp;
+
+    srrRestoreResp.m_status = statusToString(Status::FAILED);
+
+    try {
+        // licensing check runs in the background while the request is parsed
+        m_licenseCache->prefetch();
+
+        TraceSpan parseSpan("phase", "parse");
+
+        cxxtools::SerializationInfo requestSi = dto::srr::deserializeJson(json);
+        SrrRestoreRequest           srrRestoreReq;
+
+        requestSi >>= srrRestoreReq;
+        parseSpan.end();
+
+        if (!srrRestoreReq.m_snapshot_id.empty() && !srrRestoreReq.m_data_ptr) {
+            loadSnapshot(srrRestoreReq);
+        }
+        applyBaseSnapshot(srrRestoreReq);
+
+        TraceSpan licenseSpan("phase", "license check");
+        if (!m_licenseCache->isConfigurable()) {
+            log_error("Restore not allowed by licensing limitations");
+            throw std::runtime_error("Restore not allowed by licensing limitations");
+        }
+        licenseSpan.end();
+
+        std::string passphrase = fty::decrypt(srrRestoreReq.m_checksum, srrRestoreReq.m_passphrase);
+
+        if (passphrase.compare(srrRestoreReq.m_passphrase) != 0) {
+            throw std::runtime_error("Invalid passphrase");
+        }
+
+        if (srrRestoreReq.m_version == "1.0" || srrRestoreReq.m_version == "2.0" || srrRestoreReq.m_version == "2.1") {
             std::list<std::string> groupsIntegrityCheckFailed; // stores groups for which integrity check failed
 
+            RestoreSelection selection(srrRestoreReq.m_include, srrRestoreReq.m_exclude);
+
+            // a v1.0 payload is restored by group, like the v2.x ones
+            const bool              v1Payload = srrRestoreReq.m_version == "1.0";
+            std::vector<SrrFeature> v1Features;
+            if (v1Payload) {
+                selection  = upgradeV1Payload(srrRestoreReq, selection, srrRestoreResp.m_status_list);
+                v1Features = srrRestoreReq.m_data_ptr->getSrrFeatures();
+            }
+
             std::shared_ptr<SrrRestoreRequestDataV2> dataPtr =
                 std::dynamic_pointer_cast<SrrRestoreRequestDataV2>(srrRestoreReq.m_data_ptr);
             auto& groups = dataPtr->m_data;
 
+            // selective restore: the groups without any selected feature are left aside, even for the checks
+            if (!selection.all()) {
+                groups.erase(std::remove_if(groups.begin(), groups.end(),
+                                 [&](const Group& group) {
+                                     return !selection.isSelected(group.m_group_id);
+                                 }),
+                    groups.end());
+                if (groups.empty()) {
+                    throw std::runtime_error("No group or feature of the payload is selected");
+                }
+            }
+
             // sort groups by restore order
             std::sort(groups.begin(), groups.end(), [&](const Group& l, const Group& r) {
                 unsigned priorityL = 0;
@@ -596,20 +1316,24 @@ dto::UserData SrrWorker::requestRestore(const std::string& json, bool force)
 
             // sort features in each group by priority
             for (auto& group : groups) {
-                std::sort(group.m_features.begin(), group.m_features.end(), [&](SrrFeature l, SrrFeature r) {
-                    return getPriority(l.m_feature_name) < getPriority(r.m_feature_name);
-                });
+                std::sort(group.m_features.begin(), group.m_features.end(),
+                    [&](const SrrFeature& l, const SrrFeature& r) {
+                        return getPriority(l.m_feature_name) < getPriority(r.m_feature_name);
+                    });
             }
 
-            // data integrity check
+            // data integrity check (none in version 1.0)
             if (force) {
                 log_warning("Restoring with force option: data integrity check will be skipped");
-            } else {
+            } else if (!v1Payload) {
                 // features in each group must be sorted by priority to evaluate correctly the data integrity
                 for (auto& group : groups) {
                     // check data integrity
+                    TraceSpan integritySpan("phase", "integrity check");
+                    integritySpan.tag("group", group.m_group_id);
                     if (!checkDataIntegrity(group)) {
                         log_error("Integrity check failed for group %s", group.m_group_id.c_str());
+                        Metrics::instance().integrityFailure();
                         groupsIntegrityCheckFailed.push_back(group.m_group_id);
                     }
                 }
@@ -623,194 +1347,422 @@ dto::UserData SrrWorker::requestRestore(const std::string& json, bool force)
             }
 
 
-            // start restore procedure
-            RestoreResponse response;
-            bool            allGroupsRestored = true;
-
+            // check that all the involved agents are alive before any destructive operation
+            std::set<std::string> requiredAgents;
             for (const auto& group : groups) {
-                const auto& groupId = group.m_group_id;
+                auto found = g_srrGroupMap.find(group.m_group_id);
+                if (found == g_srrGroupMap.end()) {
+                    continue;
+                }
+                for (const auto& fp : found->second.m_fp) {
+                    if (selection.isSelected(group.m_group_id, fp.m_feature)) {
+                        requiredAgents.insert(g_srrFeatureMap.at(fp.m_feature).m_agent);
+                    }
+                }
+            }
+            const std::set<std::string> unresponsiveAgents = checkAgentsBeforeRestore(requiredAgents);
 
-                if (g_srrGroupMap.find(group.m_group_id) == g_srrGroupMap.end()) {
-                    RestoreStatus restoreStatus;
-                    restoreStatus.m_name   = groupId;
-                    restoreStatus.m_status = statusToString(Status::FAILED);
-                    restoreStatus.m_error =
-                        TRANSLATE_ME("Group %s is not supported. Will not be restored", groupId.c_str());
+            // compile the whole plan before any destructive operation
+            TraceSpan   planSpan("phase", "plan");
+            RestorePlan plan = compileRestorePlan(groups, srrRestoreReq.m_version, unresponsiveAgents, selection);
+            planSpan.end();
 
-                    srrRestoreResp.m_status_list.push_back(restoreStatus);
+            if (srrRestoreReq.m_dry_run) {
+                estimateRestorePlan(plan, m_agentLatency, std::chrono::seconds(FEATURE_RESTORE_DELAY_SEC));
+                srrRestoreResp.m_plan   = std::make_shared<RestorePlan>(plan);
+                srrRestoreResp.m_status = statusToString(Status::SUCCESS);
+            } else {
+                restart = executeRestorePlan(plan, srrRestoreReq, srrRestoreResp);
+            }
 
-                    log_error(restoreStatus.m_error.c_str());
+            if (v1Payload) {
+                toV1Response(srrRestoreResp, v1Features);
+            }
+        } else {
+            throw SrrInvalidVersion();
+        }
+    } catch (const SrrIntegrityCheckFailed& e) {
+        srrRestoreResp.m_status = statusToString(Status::UNKNOWN);
+        srrRestoreResp.m_error  = TRANSLATE_ME(e.what());
 
-                    allGroupsRestored = false;
-                    continue;
-                }
+        log_error(srrRestoreResp.m_error.c_str());
+    } catch (const std::exception& e) {
+        srrRestoreResp.m_status = statusToString(Status::FAILED);
+        srrRestoreResp.m_error  = TRANSLATE_ME(e.what());
 
-                std::map<std::string, dto::srr::FeatureAndStatus> ftMap;
-                for (const auto& feature : group.m_features) {
-                    ftMap[feature.m_feature_name] = feature.m_feature_and_status;
-                }
+        log_error(srrRestoreResp.m_error.c_str());
+    }
 
-                // create all restore queries related to the current group
-                // it helps to detect at an early stage if there are features missing in the restore payload
-                std::map<FeatureName, RestoreQuery> restoreQueriesMap;
+    cxxtools::SerializationInfo responseSi;
+    responseSi <<= srrRestoreResp;
 
-                try {
-                    // loop through all required features to create the restore queries
-                    for (const auto& feature : g_srrGroupMap.at(groupId).m_fp) {
-                        const auto& featureName = feature.m_feature;
-                        try {
-                            const auto& dtoFeature = ftMap.at(featureName).feature();
-
-                            // prepare restore queries
-                            RestoreQuery& request = restoreQueriesMap[featureName];
-                            request.set_passpharse(srrRestoreReq.m_passphrase);
-                            request.set_session_token(srrRestoreReq.m_sessionToken);
-                            request.mutable_map_features_data()->insert({featureName, dtoFeature});
-                        } catch (const std::out_of_range& e) {
-                            // missing feature, check if it required in restore payload version
-                            const auto requiredIn = g_srrFeatureMap.at(featureName).m_requiredIn;
-                            if (auto found = std::find(requiredIn.begin(), requiredIn.end(), srrRestoreReq.m_version);
-                                found != requiredIn.end()) {
-                                log_error("Feature %s is required in version %s", featureName.c_str(),
-                                    srrRestoreReq.m_version);
-                                throw std::runtime_error(
-                                    "Feature " + featureName + " is required in version " + srrRestoreReq.m_version);
-                            }
-                        } catch (const std::exception& e) {
-                            throw std::runtime_error(e.what());
-                        }
-                    }
-                } // if one feature is missing, set the error for the whole group and skip the group
-                catch (std::out_of_range& ex) {
-                    RestoreStatus restoreStatus;
-                    restoreStatus.m_name   = groupId;
-                    restoreStatus.m_status = statusToString(Status::FAILED);
-                    restoreStatus.m_error =
-                        TRANSLATE_ME("Group %s cannot be restored. Missing features", groupId.c_str());
+    dto::UserData response;
+    response.push_back(srrRestoreResp.m_status);
+    response.push_back(serializeJson(responseSi));
 
-                    srrRestoreResp.m_status_list.push_back(restoreStatus);
+    if (restart) {
+        reboot();
+    }
 
-                    log_error(restoreStatus.m_error.c_str());
+    operationSpan.end();
+    exportTrace("restore", traceStart);
 
-                    allGroupsRestored = false;
-                    continue;
-                }
+    return response;
+}
 
-                // get list of features in the group (based on current version)
-                const auto featureList = g_srrGroupMap.at(group.m_group_id).m_fp;
+dto::UserData SrrWorker::requestReset(const std::string& json)
+{
+    bool restart = false;
 
-                // save group status to perform a rollback in case of error
-                SaveResponse rollbackSaveResponse;
-                try {
-                    for (const auto& feature : featureList) {
-                        log_debug("Saving feature %s current status", feature.m_feature.c_str());
-                        rollbackSaveResponse +=
-                            saveFeature(feature.m_feature, srrRestoreReq.m_passphrase, srrRestoreReq.m_sessionToken);
-                    }
-                } catch (std::exception& ex) {
-                    log_error("Could not backup feature %s", groupId.c_str());
+    log_debug("SRR reset request");
+
+    const int64_t traceStart = Tracer::nowUs();
+    TraceSpan     operationSpan("operation", "reset");
+
+    SrrResetResponse srrResetResp;
+
+    srrResetResp.m_status = statusToString(Status::FAILED);
+
+    try {
+        m_licenseCache->prefetch();
+
+        TraceSpan parseSpan("phase", "parse");
+
+        SrrResetRequest srrResetReq;
+        if (auto ret = pack::json::deserialize(json, srrResetReq); !ret) {
+            throw std::runtime_error(ret.error());
+        }
+        parseSpan.end();
+
+        const std::string& passphrase   = srrResetReq.m_passphrase.value();
+        const std::string& sessionToken = srrResetReq.m_sessionToken.value();
+
+        TraceSpan licenseSpan("phase", "license check");
+        if (!m_licenseCache->isConfigurable()) {
+            log_error("Reset not allowed by licensing limitations");
+            throw std::runtime_error("Reset not allowed by licensing limitations");
+        }
+        licenseSpan.end();
+
+        if (!srr::checkPassphraseFormat(passphrase)) {
+            throw std::runtime_error(
+                TRANSLATE_ME("Passphrase must have %s characters", (fty::getPassphraseFormat()).c_str()));
+        }
+
+        // groups are reset in the reverse of the restore order, once each
+        std::vector<std::string> groupIds;
+        std::set<std::string>    listedGroups;
+        for (const auto& groupId : srrResetReq.m_group_list) {
+            if (!listedGroups.insert(groupId).second) {
+                continue;
+            }
+            if (g_srrGroupMap.find(groupId) == g_srrGroupMap.end()) {
+                RestoreStatus resetStatus;
+                resetStatus.m_name   = groupId;
+                resetStatus.m_status = statusToString(Status::FAILED);
+                resetStatus.m_error  = TRANSLATE_ME("Group %s is not supported. Will not be reset", groupId.c_str());
+
+                log_error(resetStatus.m_error.c_str());
+                srrResetResp.m_status_list.push_back(resetStatus);
+                continue;
+            }
+            groupIds.push_back(groupId);
+        }
+        std::sort(groupIds.begin(), groupIds.end(), [](const std::string& l, const std::string& r) {
+            return g_srrGroupMap.at(l).m_restoreOrder > g_srrGroupMap.at(r).m_restoreOrder;
+        });
+
+        std::set<std::string> requiredAgents;
+        for (const auto& groupId : groupIds) {
+            const auto groupAgents = getGroupAgents(groupId);
+            requiredAgents.insert(groupAgents.begin(), groupAgents.end());
+        }
+        const std::set<std::string> unresponsiveAgents = checkAgentsBeforeRestore(requiredAgents);
+
+        // save the groups first, a group which can't be saved is not reset as it could not be rolled back
+        TraceSpan                           backupSpan("phase", "backup");
+        std::map<std::string, SaveResponse> backups;
+        std::map<std::string, Timings>      groupTimings;
+        SrrSaveResponse                     snapshot;
+
+        for (const auto& groupId : groupIds) {
+            RestoreStatus resetStatus;
+            resetStatus.m_name   = groupId;
+            resetStatus.m_status = statusToString(Status::FAILED);
+
+            Timings& timings = groupTimings[groupId];
+            timings.m_name   = groupId;
+
+            std::set<std::string> groupUnresponsiveAgents;
+            for (const auto& agent : getGroupAgents(groupId)) {
+                if (unresponsiveAgents.count(agent)) {
+                    groupUnresponsiveAgents.insert(agent);
                 }
+            }
+            if (!groupUnresponsiveAgents.empty()) {
+                resetStatus.m_error = TRANSLATE_ME("Group %s not reset: agents not responding (%s)", groupId.c_str(),
+                    joinNames(groupUnresponsiveAgents).c_str());
 
-                // reset features in reverse order before restore
-                // WARNING: currently reset is not implemented by all features, hence it will not be mandatory
-                for (auto revIt = featureList.rbegin(); revIt != featureList.rend(); revIt++) {
-                    if (g_srrFeatureMap.at(revIt->m_feature).m_reset) {
-                        try {
-                            resetFeature(revIt->m_feature);
-                        } catch (SrrResetFailed& ex) {
-                            log_warning(ex.what());
-                        }
+                log_error(resetStatus.m_error.c_str());
+                srrResetResp.m_status_list.push_back(resetStatus);
+                continue;
+            }
+
+            Group group;
+            group.m_group_id   = groupId;
+            group.m_group_name = groupId;
+            try {
+                for (const auto& feature : g_srrGroupMap.at(groupId).m_fp) {
+                    Timings featureTimings;
+                    featureTimings.m_name = feature.m_feature;
+
+                    const auto   start = std::chrono::steady_clock::now();
+                    SaveResponse saveResp = saveFeatureShared(feature.m_feature, passphrase, sessionToken);
+                    featureTimings.m_backup_ms = msSince(start);
+
+                    backups[groupId] += saveResp;
+                    for (auto& fs : *saveResp.mutable_map_features_data()) {
+                        SrrFeature f;
+                        f.m_feature_name = fs.first;
+                        f.m_feature_and_status.Swap(&fs.second);
+                        group.m_features.push_back(std::move(f));
                     }
+                    timings.m_features.push_back(featureTimings);
                 }
+            } catch (const std::exception& ex) {
+                backups.erase(groupId);
 
-                bool restoreFailed = false;
-
-                RestoreStatus restoreStatus;
-                restoreStatus.m_name   = groupId;
-                restoreStatus.m_status = statusToString(Status::SUCCESS);
+                resetStatus.m_error =
+                    TRANSLATE_ME("Group %s not reset: could not be saved (%s)", groupId.c_str(), ex.what());
 
-                // restore features in order
-                for (const auto& feature : group.m_features) {
-                    const auto& featureName = feature.m_feature_name;
+                log_error(resetStatus.m_error.c_str());
+                srrResetResp.m_status_list.push_back(resetStatus);
+                continue;
+            }
 
-                    try {
-                        // Restore feature
-                        response += restoreFeature(featureName, restoreQueriesMap[featureName]);
+            evalDataIntegrity(group);
+            snapshot.m_data.push_back(group);
+        }
+        backupSpan.end();
 
-                        // update restart flag
-                        restart = restart | g_srrFeatureMap.at(featureName).m_restart;
-                    } catch (const std::exception& ex) {
-                        // restore failed -> rolling back the whole group
-                        restoreFailed = true;
+        if (m_snapshotStore && !snapshot.m_data.empty()) {
+            snapshot.m_version  = m_srrVersion;
+            snapshot.m_checksum = fty::encrypt(passphrase, passphrase);
+            try {
+                srrResetResp.m_snapshot_id = m_snapshotStore->store(snapshot).m_id;
+            } catch (const std::exception& e) {
+                log_error("Failed to store the snapshot before reset: %s", e.what());
+            }
+        }
 
-                        restoreStatus.m_status = statusToString(Status::FAILED);
-                        restoreStatus.m_error =
-                            TRANSLATE_ME("Restore failed for feature %s: ", featureName.c_str(), ex.what());
+        bool allGroupsReset = srrResetResp.m_status_list.empty();
 
-                        allGroupsRestored = false;
-                        log_error(restoreStatus.m_error.c_str());
+        // reset the groups one at a time in reverse restore order, the agents of a group concurrently
+        for (const auto& groupId : groupIds) {
+            if (backups.find(groupId) == backups.end()) {
+                continue;
+            }
 
-                        // stop group restore
-                        break;
+            TraceSpan resetSpan("phase", "reset");
+            resetSpan.tag("group", groupId);
+            std::map<FeatureName, uint64_t>    resetDurations;
+            std::map<FeatureName, std::string> resetErrors =
+                resetFeatures(getResetFeatures(groupId), resetDurations);
+            resetSpan.end();
+
+            Timings& timings = groupTimings[groupId];
+
+            RestoreStatus resetStatus;
+            resetStatus.m_name   = groupId;
+            resetStatus.m_status = statusToString(Status::SUCCESS);
+
+            std::vector<std::string> groupErrors;
+            uint64_t                 rollbackMs = 0;
+            for (const auto& feature : g_srrGroupMap.at(groupId).m_fp) {
+                if (resetDurations.count(feature.m_feature)) {
+                    for (auto& featureTimings : timings.m_features) {
+                        if (featureTimings.m_name == feature.m_feature) {
+                            featureTimings.m_reset_ms = resetDurations.at(feature.m_feature);
+                        }
                     }
-
-                    // wait to sync feature restore
-                    std::this_thread::sleep_for(std::chrono::seconds(FEATURE_RESTORE_DELAY_SEC));
+                }
+                if (g_srrFeatureMap.at(feature.m_feature).m_reset) {
+                    restart = restart | g_srrFeatureMap.at(feature.m_feature).m_restart;
                 }
 
-                // if restore failed -> rollback
-                if (restoreFailed) {
-                    restart = restart | rollback(rollbackSaveResponse, srrRestoreReq.m_passphrase);
+                auto error = resetErrors.find(feature.m_feature);
+                if (error != resetErrors.end()) {
+                    groupErrors.push_back(error->second);
                 }
+            }
 
-                // push group status into restore response
-                srrRestoreResp.m_status_list.push_back(restoreStatus);
+            // a partially reset group is restored to its previous state
+            if (!groupErrors.empty()) {
+                allGroupsReset = false;
+
+                resetStatus.m_status = statusToString(Status::FAILED);
+                resetStatus.m_error  = TRANSLATE_ME("Reset failed for group %s: %s", groupId.c_str(),
+                    std::accumulate(groupErrors.begin(), groupErrors.end(), std::string(" ")).c_str());
+                log_error(resetStatus.m_error.c_str());
+
+                std::map<FeatureName, uint64_t> rollbackDurations;
+                std::map<FeatureName, uint64_t> rollbackSettles;
+                const auto                      start = std::chrono::steady_clock::now();
+                restart    = restart | rollback(backups.at(groupId), passphrase, rollbackDurations, rollbackSettles);
+                rollbackMs = msSince(start);
+                for (auto& featureTimings : timings.m_features) {
+                    if (rollbackDurations.count(featureTimings.m_name)) {
+                        featureTimings.m_rollback_ms = rollbackDurations.at(featureTimings.m_name);
+                    }
+                    if (rollbackSettles.count(featureTimings.m_name)) {
+                        featureTimings.m_settle_ms += rollbackSettles.at(featureTimings.m_name);
+                    }
+                }
             }
 
-            if (allGroupsRestored) {
-                srrRestoreResp.m_status = statusToString(Status::SUCCESS);
-            } else {
-                srrRestoreResp.m_status = statusToString(Status::PARTIAL_SUCCESS);
+            for (const auto& featureTimings : timings.m_features) {
+                timings += featureTimings;
             }
-        } else {
-            throw SrrInvalidVersion();
+            // the features are rolled back concurrently, the group reports the elapsed time
+            if (!groupErrors.empty()) {
+                timings.m_rollback_ms = rollbackMs;
+            }
+            srrResetResp.m_timings.push_back(timings);
+            srrResetResp.m_status_list.push_back(resetStatus);
         }
-    } catch (const SrrIntegrityCheckFailed& e) {
-        srrRestoreResp.m_status = statusToString(Status::UNKNOWN);
-        srrRestoreResp.m_error  = TRANSLATE_ME(e.what());
 
-        log_error(srrRestoreResp.m_error.c_str());
+        if (allGroupsReset) {
+            srrResetResp.m_status = statusToString(Status::SUCCESS);
+        } else if (std::any_of(srrResetResp.m_status_list.begin(), srrResetResp.m_status_list.end(),
+                       [](const RestoreStatus& status) {
+                           return status.m_status == statusToString(Status::SUCCESS);
+                       })) {
+            srrResetResp.m_status = statusToString(Status::PARTIAL_SUCCESS);
+        }
     } catch (const std::exception& e) {
-        srrRestoreResp.m_status = statusToString(Status::FAILED);
-        srrRestoreResp.m_error  = TRANSLATE_ME(e.what());
+        srrResetResp.m_status = statusToString(Status::FAILED);
+        srrResetResp.m_error  = TRANSLATE_ME(e.what());
 
-        log_error(srrRestoreResp.m_error.c_str());
+        log_error(srrResetResp.m_error.c_str());
     }
 
     cxxtools::SerializationInfo responseSi;
-    responseSi <<= srrRestoreResp;
+    responseSi <<= srrResetResp;
 
     dto::UserData response;
-    std::string   jsonResp = serializeJson(responseSi);
-    response.push_back(srrRestoreResp.m_status);
-    response.push_back(jsonResp);
+    response.push_back(srrResetResp.m_status);
+    response.push_back(serializeJson(responseSi));
 
+    // one reboot for all the groups
     if (restart) {
-        if (m_parameters.at(ENABLE_REBOOT_KEY) == "true") {
-            std::thread restartThread(restartBiosService, SRR_RESTART_DELAY_SEC);
-            restartThread.detach();
-        } else {
-            log_warning("Reboot is disabled in current configuration");
-        }
+        reboot();
     }
 
+    operationSpan.end();
+    exportTrace("reset", traceStart);
+
     return response;
 }
 
-dto::UserData SrrWorker::requestReset(const std::string& /* json */)
+void SrrWorker::reboot()
 {
-    log_debug("SRR reset request");
-    throw SrrException("Not implemented yet!");
+    if (m_parameters.at(ENABLE_REBOOT_KEY) == "true") {
+        Metrics::instance().reboot();
+        std::thread restartThread(restartBiosService, SRR_RESTART_DELAY_SEC, std::ref(m_clock));
+        restartThread.detach();
+    } else {
+        log_warning("Reboot is disabled in current configuration");
+    }
+}
+
+dto::UserData SrrWorker::getSnapshotList()
+{
+    SrrSnapshotListResponse snapshotListResp;
+    if (m_snapshotStore) {
+        snapshotListResp.m_snapshots = m_snapshotStore->list();
+    }
+
+    cxxtools::SerializationInfo si;
+    si <<= snapshotListResp;
+
+    dto::UserData response;
+    response.push_back(dto::srr::serializeJson(si));
+
+    return response;
+}
+
+void SrrWorker::loadSnapshot(SrrRestoreRequest& request)
+{
+    TraceSpan span("phase", "load snapshot");
+    span.tag("snapshot", request.m_snapshot_id);
+
+    if (!m_snapshotStore) {
+        throw std::runtime_error("Snapshots are not enabled");
+    }
+
+    const SnapshotManifest manifest = m_snapshotStore->manifest(request.m_snapshot_id);
+
+    std::shared_ptr<SrrRestoreRequestDataV2> dataPtr(new SrrRestoreRequestDataV2);
+    dataPtr->m_data = m_snapshotStore->load(request.m_snapshot_id);
+
+    request.m_version  = manifest.m_version;
+    request.m_data_ptr = dataPtr;
+    if (request.m_checksum.empty()) {
+        request.m_checksum = manifest.m_checksum;
+    }
+}
+
+void SrrWorker::applyBaseSnapshot(SrrRestoreRequest& request)
+{
+    auto dataPtr = std::dynamic_pointer_cast<SrrRestoreRequestDataV2>(request.m_data_ptr);
+    if (!dataPtr) {
+        return;
+    }
+
+    const bool isDelta = std::any_of(dataPtr->m_data.begin(), dataPtr->m_data.end(), [](const Group& group) {
+        return std::any_of(group.m_features.begin(), group.m_features.end(), [](const SrrFeature& feature) {
+            return !feature.m_ref.empty();
+        });
+    });
+    if (!isDelta) {
+        return;
+    }
+
+    TraceSpan span("phase", "apply delta");
+    span.tag("snapshot", request.m_base_snapshot_id);
+
+    if (request.m_base_snapshot_id.empty()) {
+        throw std::runtime_error("Delta data without base snapshot");
+    }
+    if (!m_snapshotStore) {
+        throw std::runtime_error("Snapshots are not enabled");
+    }
+    applyDelta(dataPtr->m_data, m_snapshotStore->load(request.m_base_snapshot_id));
+}
+
+dto::UserData SrrWorker::getTrace()
+{
+    dto::UserData response;
+    response.push_back(Tracer::instance().exportChromeTrace());
+
+    return response;
+}
+
+void SrrWorker::exportTrace(const std::string& operation, int64_t sinceUs)
+{
+    if (m_traceDir.empty() || !Tracer::instance().isEnabled()) {
+        return;
+    }
+
+    const std::string path = m_traceDir + "/srr-" + operation + "-" + std::to_string(sinceUs) + ".json";
+
+    std::ofstream file(path);
+    file << Tracer::instance().exportChromeTrace(sinceUs);
+    if (!file) {
+        log_error("Failed to write trace file %s", path.c_str());
+    } else {
+        log_info("Trace of %s written to %s", operation.c_str(), path.c_str());
+    }
 }
 
 bool SrrWorker::isVerstionCompatible(const std::string& version)
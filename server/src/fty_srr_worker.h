@@ -21,48 +21,142 @@
 
 #pragma once
 
+#include "helpers/agentLatency.h"
+#include "helpers/clock.h"
+#include "helpers/singleFlight.h"
+#include <chrono>
 #include <fty_common_dto.h>
 #include <fty_common_messagebus.h>
 #include <fty_userdata_dto.h>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace srr {
+class LicenseCache;
+class SaveCache;
+class MessageBusPool;
+class PlanStep;
+class RestorePlan;
+class SnapshotStore;
+class SrrRestoreRequest;
+class SrrRestoreResponse;
 
 class SrrWorker
 {
 public:
-    SrrWorker(messagebus::MessageBus& msgBus, const std::map<std::string, std::string>& parameters,
-        const std::set<std::string>& supportedVersions);
-    ~SrrWorker() = default;
+    SrrWorker(MessageBusPool& busPool, const std::map<std::string, std::string>& parameters,
+        const std::set<std::string>& supportedVersions, Clock& clock = Clock::system());
+    ~SrrWorker();
 
     // UI interface
     dto::UserData getGroupList();
     dto::UserData requestSave(const std::string& json);
     dto::UserData requestRestore(const std::string& json, bool force = false);
     dto::UserData requestReset(const std::string& json);
+    dto::UserData getTrace();
+    dto::UserData getSnapshotList();
 
 private:
-    messagebus::MessageBus&            m_msgBus;
+    MessageBusPool&                    m_busPool;
     std::map<std::string, std::string> m_parameters;
     std::string                        m_srrVersion;
+    Clock&                             m_clock;
 
     std::set<std::string> m_supportedVersions;
 
     int m_sendTimeout;
 
+    std::unique_ptr<LicenseCache> m_licenseCache;
+    AgentLatencyTracker           m_agentLatency;
+    SaveSingleFlight              m_saveFlights;
+
+    std::string               m_preflightMode;
+    std::chrono::milliseconds m_preflightTimeout;
+
+    std::string m_traceDir;
+
+    // local snapshots of the saves, if enabled
+    std::unique_ptr<SnapshotStore> m_snapshotStore;
+
+    // saved features kept fresh by the change events, if enabled
+    std::unique_ptr<SaveCache> m_saveCache;
+
     void init();
     // void buildMapAssociation();
     bool isVerstionCompatible(const std::string& version);
 
+    messagebus::Message sendAgentRequest(AgentOperation op, dto::UserData data, const std::string& action,
+        const std::string& queueNameDest, const std::string& agentNameDest);
+
+    // return the agents which did not answer a ping before the preflight deadline
+    std::set<std::string> findUnresponsiveAgents(const std::set<std::string>& agents);
+    std::set<std::string> checkAgentsBeforeRestore(const std::set<std::string>& agents);
+    // return the agents which did not answer a ping before the timeout
+    std::set<std::string> pingAgents(const std::set<std::string>& agents, std::chrono::milliseconds timeout);
+
+    // write the trace of an operation in the trace directory, if any
+    void exportTrace(const std::string& operation, int64_t sinceUs);
+
+    // fill the data of a restore request from the local snapshot it refers to
+    void loadSnapshot(SrrRestoreRequest& request);
+    // rebuild the features of a delta restore request from its base snapshot
+    void applyBaseSnapshot(SrrRestoreRequest& request);
+
     // SRR methods
     dto::srr::SaveResponse saveFeature(
         const dto::srr::FeatureName& featureName, const std::string& passphrase, const std::string& sessionToken);
-    dto::srr::RestoreResponse restoreFeature(
-        const dto::srr::FeatureName& featureName, const dto::srr::RestoreQuery& query);
-    dto::srr::ResetResponse resetFeature(const dto::srr::FeatureName& featureName);
-    bool                    rollback(const dto::srr::SaveResponse& rollbackSaveResponse, const std::string& passphrase);
+    // same, sharing the agent call with the identical saves in flight
+    dto::srr::SaveResponse saveFeatureShared(
+        const dto::srr::FeatureName& featureName, const std::string& passphrase, const std::string& sessionToken);
+    // restore the features of a plan step with one query to its agent
+    // the query is consumed, its feature data is handed over to the bus message without copy
+    dto::srr::RestoreResponse restoreStep(const PlanStep& step, dto::srr::RestoreQuery query);
+
+    // make stale the cached saves of features whose configuration is changed by a reset or a restore
+    void invalidateSavedFeatures(const std::vector<dto::srr::FeatureName>& features);
+
+    /**
+     * Reset features, the agents being reset concurrently
+     * @param features Features in reset order (the features of an agent are sent in one query, in this order)
+     * @param durationsMs Filled with the reset duration of each feature (the duration of its agent query)
+     * @return The features which failed to reset, with their error
+     */
+    std::map<dto::srr::FeatureName, std::string> resetFeatures(
+        const std::vector<dto::srr::FeatureName>& features, std::map<dto::srr::FeatureName, uint64_t>& durationsMs);
+
+    /**
+     * Restore features with the given data, the agents being restored concurrently
+     * @param features Features to restore, without dependency between them
+     * @param data Saved data of the features, the data of the restored features is moved into the queries
+     * @param passphrase
+     * @param durationsMs Increased by the restore duration of each feature (the duration of its agent query)
+     * @return The features which failed to restore, with their error
+     */
+    std::map<dto::srr::FeatureName, std::string> restoreFeatures(const std::vector<dto::srr::FeatureName>& features,
+        dto::srr::SaveResponse& data, const std::string& passphrase,
+        std::map<dto::srr::FeatureName, uint64_t>& durationsMs);
+
+    /**
+     * Restore the saved state of features, the features of a same priority concurrently
+     * @param rollbackSaveResponse Saved state of the features, its data is moved into the restore queries
+     * @param passphrase
+     * @param durationsMs Increased by the reset and restore durations of each feature
+     * @param settleMs Increased by the settle time after the restore of each feature
+     * @return True if a restart is needed
+     */
+    bool rollback(dto::srr::SaveResponse& rollbackSaveResponse, const std::string& passphrase,
+        std::map<dto::srr::FeatureName, uint64_t>& durationsMs, std::map<dto::srr::FeatureName, uint64_t>& settleMs);
+
+    // restore the groups of a compiled plan, return true if a restart is needed
+    // the feature data of the request is moved into the restore queries
+    bool executeRestorePlan(
+        const RestorePlan& plan, const SrrRestoreRequest& srrRestoreReq, SrrRestoreResponse& srrRestoreResp);
+
+    // reboot after a restore or a reset, if enabled
+    void reboot();
 };
 
 } // namespace srr
@@ -0,0 +1,134 @@
+/*  =========================================================================
+    agentLatency - Agent latency history and adaptive timeouts
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/agentLatency.h"
+#include <algorithm>
+#include <vector>
+
+// minimum number of samples before trusting the history
+#define LATENCY_MIN_SAMPLES  5
+// percentile used to evaluate the timeout
+#define LATENCY_PERCENTILE   0.99
+// timeout = LATENCY_FACTOR * percentile
+#define LATENCY_FACTOR       4
+// default floor, the timeout never goes below (seconds)
+#define LATENCY_FLOOR_SEC    10
+// default hard cap (seconds)
+#define LATENCY_DEFAULT_CAP  60
+
+namespace srr {
+
+AgentLatencyTracker::AgentLatencyTracker(size_t historySize)
+    : m_historySize(historySize)
+{
+}
+
+void AgentLatencyTracker::setCap(AgentOperation op, std::chrono::seconds cap)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_caps[op] = cap;
+}
+
+void AgentLatencyTracker::setFloor(AgentOperation op, std::chrono::seconds floor)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_floors[op] = floor;
+}
+
+void AgentLatencyTracker::setOverride(const std::string& queue, std::chrono::seconds timeout)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_overrides[queue] = timeout;
+}
+
+void AgentLatencyTracker::record(const std::string& queue, AgentOperation op, std::chrono::milliseconds latency)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    History&                    history = m_history[{queue, op}];
+
+    history.push_back(latency);
+    while (history.size() > m_historySize) {
+        history.pop_front();
+    }
+}
+
+std::chrono::seconds AgentLatencyTracker::timeout(const std::string& queue, AgentOperation op) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto overrideIt = m_overrides.find(queue);
+    if (overrideIt != m_overrides.end()) {
+        return overrideIt->second;
+    }
+
+    auto                 capIt = m_caps.find(op);
+    std::chrono::seconds cap   = (capIt != m_caps.end()) ? capIt->second : std::chrono::seconds(LATENCY_DEFAULT_CAP);
+
+    auto historyIt = m_history.find({queue, op});
+    if (historyIt == m_history.end() || historyIt->second.size() < LATENCY_MIN_SAMPLES) {
+        return cap;
+    }
+
+    const auto adaptive = std::chrono::duration_cast<std::chrono::seconds>(
+        percentileLocked(historyIt->second, LATENCY_PERCENTILE) * LATENCY_FACTOR + std::chrono::milliseconds(999));
+
+    auto                 floorIt = m_floors.find(op);
+    std::chrono::seconds floor =
+        (floorIt != m_floors.end()) ? floorIt->second : std::chrono::seconds(LATENCY_FLOOR_SEC);
+
+    return std::min(cap, std::max(floor, adaptive));
+}
+
+std::chrono::milliseconds AgentLatencyTracker::percentile(
+    const std::string& queue, AgentOperation op, double p) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto historyIt = m_history.find({queue, op});
+    if (historyIt == m_history.end()) {
+        return std::chrono::milliseconds(0);
+    }
+    return percentileLocked(historyIt->second, p);
+}
+
+size_t AgentLatencyTracker::samples(const std::string& queue, AgentOperation op) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto historyIt = m_history.find({queue, op});
+    return (historyIt == m_history.end()) ? 0 : historyIt->second.size();
+}
+
+std::chrono::milliseconds AgentLatencyTracker::percentileLocked(const History& history, double p) const
+{
+    if (history.empty()) {
+        return std::chrono::milliseconds(0);
+    }
+
+    std::vector<std::chrono::milliseconds> sorted(history.begin(), history.end());
+    size_t rank = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    rank        = std::min(rank, sorted.size() - 1);
+
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<long>(rank), sorted.end());
+    return sorted[rank];
+}
+
+} // namespace srr
@@ -0,0 +1,93 @@
+/*  =========================================================================
+    agentLatency - Agent latency history and adaptive timeouts
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace srr {
+
+enum class AgentOperation
+{
+    SAVE,
+    RESTORE,
+    RESET
+};
+
+/**
+ * Keeps the latest response times of each agent queue, per operation, and
+ * derives the timeout of the next request from them.
+ *
+ * The timeout is a multiple of the observed high percentile, never below the
+ * floor and never above the hard cap of the operation. Until enough samples
+ * are known, the cap is used. A per queue override replaces the adaptive value.
+ * An operation whose floor is its cap is not adapted, its latencies are only
+ * kept for the estimates.
+ */
+class AgentLatencyTracker
+{
+public:
+    explicit AgentLatencyTracker(size_t historySize = 64);
+
+    void setCap(AgentOperation op, std::chrono::seconds cap);
+    void setFloor(AgentOperation op, std::chrono::seconds floor);
+    void setOverride(const std::string& queue, std::chrono::seconds timeout);
+
+    void record(const std::string& queue, AgentOperation op, std::chrono::milliseconds latency);
+
+    /**
+     * Get the timeout to use for the next request
+     * @param queue Agent queue
+     * @param op Operation
+     * @return Timeout in seconds
+     */
+    std::chrono::seconds timeout(const std::string& queue, AgentOperation op) const;
+
+    /**
+     * Get a percentile of the recorded latencies
+     * @param queue Agent queue
+     * @param op Operation
+     * @param p Percentile, between 0 and 1
+     * @return Latency, 0 if nothing was recorded
+     */
+    std::chrono::milliseconds percentile(const std::string& queue, AgentOperation op, double p) const;
+
+    size_t samples(const std::string& queue, AgentOperation op) const;
+
+private:
+    using History = std::deque<std::chrono::milliseconds>;
+
+    size_t m_historySize;
+
+    mutable std::mutex                                        m_mutex;
+    std::map<std::pair<std::string, AgentOperation>, History> m_history;
+    std::map<AgentOperation, std::chrono::seconds>            m_caps;
+    std::map<AgentOperation, std::chrono::seconds>            m_floors;
+    std::map<std::string, std::chrono::seconds>               m_overrides;
+
+    std::chrono::milliseconds percentileLocked(const History& history, double p) const;
+};
+
+} // namespace srr
@@ -0,0 +1,121 @@
+/*  =========================================================================
+    busPool - Pool of back end message bus clients
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/busPool.h"
+#include <fty_common.h>
+
+namespace srr {
+
+MessageBusPool::Handle::Handle(MessageBusPool& pool, size_t index)
+    : m_pool(&pool)
+    , m_index(index)
+{
+}
+
+MessageBusPool::Handle::Handle(Handle&& other)
+    : m_pool(other.m_pool)
+    , m_index(other.m_index)
+{
+    other.m_pool = nullptr;
+}
+
+MessageBusPool::Handle::~Handle()
+{
+    if (m_pool) {
+        m_pool->giveBack(m_index);
+    }
+}
+
+messagebus::MessageBus& MessageBusPool::Handle::bus()
+{
+    return *(m_pool->m_clients.at(m_index).m_bus);
+}
+
+const std::string& MessageBusPool::Handle::clientName() const
+{
+    return m_pool->m_clients.at(m_index).m_name;
+}
+
+/**
+ * Constructor: connects all the clients
+ * @param endpoint Malamute endpoint
+ * @param clientName Prefix of the client names
+ * @param size Number of clients
+ */
+MessageBusPool::MessageBusPool(const std::string& endpoint, const std::string& clientName, size_t size)
+{
+    if (size == 0) {
+        size = 1;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        Client client;
+        // keep the agent name for the first client, agents may rely on it
+        client.m_name = (i == 0) ? clientName : clientName + "-" + std::to_string(i);
+        client.m_bus  = std::unique_ptr<messagebus::MessageBus>(messagebus::MlmMessageBus(endpoint, client.m_name));
+        client.m_bus->connect();
+
+        m_clients.push_back(std::move(client));
+        m_free.push_back(size - 1 - i);
+    }
+
+    m_stats.m_size = size;
+}
+
+MessageBusPool::Handle MessageBusPool::checkout()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_stats.m_checkouts++;
+    if (m_free.empty()) {
+        m_stats.m_waits++;
+        log_debug("All %zu message bus clients are busy, waiting", m_clients.size());
+        m_cv.wait(lock, [&]() {
+            return !m_free.empty();
+        });
+    }
+
+    size_t index = m_free.back();
+    m_free.pop_back();
+
+    m_stats.m_inUse++;
+    m_stats.m_peakInUse = std::max(m_stats.m_peakInUse, m_stats.m_inUse);
+
+    return Handle(*this, index);
+}
+
+MessageBusPool::Stats MessageBusPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void MessageBusPool::giveBack(size_t index)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(index);
+        m_stats.m_inUse--;
+    }
+    m_cv.notify_one();
+}
+
+} // namespace srr
@@ -0,0 +1,99 @@
+/*  =========================================================================
+    busPool - Pool of back end message bus clients
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <fty_common_messagebus.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace srr {
+
+/**
+ * Fixed size pool of connected message bus clients.
+ * Each client has its own malamute address, so a checked out client can be
+ * used for requests without interfering with the other users of the pool.
+ */
+class MessageBusPool
+{
+public:
+    struct Stats
+    {
+        size_t   m_size      = 0;
+        size_t   m_inUse     = 0;
+        size_t   m_peakInUse = 0;
+        uint64_t m_checkouts = 0;
+        uint64_t m_waits     = 0; // checkouts which had to wait for a free client
+    };
+
+    /**
+     * Client checked out of the pool, given back on destruction
+     */
+    class Handle
+    {
+    public:
+        Handle(MessageBusPool& pool, size_t index);
+        Handle(Handle&& other);
+        Handle& operator=(Handle&&) = delete;
+        Handle(const Handle&)       = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle();
+
+        messagebus::MessageBus& bus();
+        const std::string&      clientName() const;
+
+    private:
+        MessageBusPool* m_pool;
+        size_t          m_index;
+    };
+
+    MessageBusPool(const std::string& endpoint, const std::string& clientName, size_t size);
+    ~MessageBusPool() = default;
+
+    /**
+     * Check out a client, waiting for one to be given back if all are in use
+     */
+    Handle checkout();
+
+    Stats stats() const;
+
+private:
+    struct Client
+    {
+        std::string                             m_name;
+        std::unique_ptr<messagebus::MessageBus> m_bus;
+    };
+
+    std::vector<Client> m_clients;
+    std::vector<size_t> m_free;
+
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_cv;
+    Stats                   m_stats;
+
+    void giveBack(size_t index);
+};
+
+} // namespace srr
@@ -0,0 +1,116 @@
+/*  =========================================================================
+    clock - Clock and sleep abstraction
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/clock.h"
+#include <algorithm>
+
+namespace srr {
+
+class SystemClock : public Clock
+{
+public:
+    TimePoint now() const override
+    {
+        return std::chrono::steady_clock::now();
+    }
+
+    void sleepFor(std::chrono::milliseconds duration) override
+    {
+        std::this_thread::sleep_for(duration);
+    }
+};
+
+Clock& Clock::system()
+{
+    static SystemClock clock;
+    return clock;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Clock::TimePoint SimulatedClock::now() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto found = m_operations.find(std::this_thread::get_id());
+    return TimePoint(found == m_operations.end() ? m_ended : found->second);
+}
+
+void SimulatedClock::sleepFor(std::chrono::milliseconds duration)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto found = m_operations.find(std::this_thread::get_id());
+    if (found == m_operations.end()) {
+        m_ended += duration;
+    } else {
+        found->second += duration;
+    }
+    m_sleepCount++;
+}
+
+void SimulatedClock::beginOperation()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // a thread id may be reused by a new thread, the operation replaces any former one
+    m_operations[std::this_thread::get_id()] = m_ended;
+}
+
+void SimulatedClock::endOperation()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto found = m_operations.find(std::this_thread::get_id());
+    if (found != m_operations.end()) {
+        m_ended = std::max(m_ended, found->second);
+        m_operations.erase(found);
+    }
+}
+
+void SimulatedClock::advance(std::chrono::milliseconds duration)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_ended += duration;
+    for (auto& operation : m_operations) {
+        operation.second += duration;
+    }
+}
+
+std::chrono::milliseconds SimulatedClock::elapsed() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::chrono::milliseconds elapsed = m_ended;
+    for (const auto& operation : m_operations) {
+        elapsed = std::max(elapsed, operation.second);
+    }
+    return elapsed;
+}
+
+unsigned long SimulatedClock::sleepCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sleepCount;
+}
+
+} // namespace srr
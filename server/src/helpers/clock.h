@@ -0,0 +1,99 @@
+/*  =========================================================================
+    clock - Clock and sleep abstraction
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace srr {
+
+/**
+ * Source of time for the fixed delays of the srr procedures (settle time
+ * after a restore, reboot countdown, ...), so that they can be simulated.
+ */
+class Clock
+{
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    virtual ~Clock() = default;
+
+    virtual TimePoint now() const                                = 0;
+    virtual void      sleepFor(std::chrono::milliseconds duration) = 0;
+
+    // the calling thread starts or ends an operation (a request of the UI)
+    virtual void beginOperation()
+    {
+    }
+    virtual void endOperation()
+    {
+    }
+
+    /**
+     * Clock backed by std::chrono::steady_clock and std::this_thread::sleep_for
+     */
+    static Clock& system();
+};
+
+/**
+ * Clock whose time only moves forward when asked to: sleeping returns
+ * immediately after advancing the time, so the logical duration of a
+ * procedure can be measured without waiting for it.
+ *
+ * Each operation has its own time, moved by the sleeps of the thread
+ * running it: the sleeps of concurrent operations overlap instead of adding
+ * up. An operation starts at the time reached by the operations which ended
+ * before it. The sleeps of a thread outside of an operation move this time
+ * directly.
+ */
+class SimulatedClock : public Clock
+{
+public:
+    SimulatedClock() = default;
+
+    // time of the operation of the calling thread
+    TimePoint now() const override;
+    // move the time of the operation of the calling thread
+    void sleepFor(std::chrono::milliseconds duration) override;
+
+    void beginOperation() override;
+    void endOperation() override;
+
+    // move the time of all the operations
+    void advance(std::chrono::milliseconds duration);
+
+    // time of the furthest operation since creation
+    std::chrono::milliseconds elapsed() const;
+
+    // number of calls to sleepFor
+    unsigned long sleepCount() const;
+
+private:
+    mutable std::mutex                                   m_mutex;
+    std::chrono::milliseconds                            m_ended{0};   // time reached by the ended operations
+    std::map<std::thread::id, std::chrono::milliseconds> m_operations; // time of the operation run by each thread
+    unsigned long                                        m_sleepCount = 0;
+};
+
+} // namespace srr
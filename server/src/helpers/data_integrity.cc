@@ -24,6 +24,7 @@
 #include "fty_srr_groups.h"
 #include <cxxtools/serializationinfo.h>
 #include <dto/common.h>
+#include <dto/snapshot.h>
 #include <fty_common.h>
 #include <iomanip>
 #include <openssl/sha.h>
@@ -46,7 +47,7 @@ std::string evalSha256(const std::string& data)
 void evalDataIntegrity(Group& group)
 {
     // sort features by priority
-    std::sort(group.m_features.begin(), group.m_features.end(), [&](SrrFeature l, SrrFeature r) {
+    std::sort(group.m_features.begin(), group.m_features.end(), [&](const SrrFeature& l, const SrrFeature& r) {
         return getPriority(l.m_feature_name) < getPriority(r.m_feature_name);
     });
 
@@ -69,4 +70,79 @@ bool checkDataIntegrity(const Group& group)
     return checksum == group.m_data_integrity;
 }
 
+// the data is only represented by its hash, which is also the name of its blob in the snapshot store
+static std::string evalFeatureHash(
+    const std::string& version, const std::string& status, const std::string& error, const std::string& dataHash)
+{
+    cxxtools::SerializationInfo tmpSi;
+    tmpSi.addMember("version") <<= version;
+    tmpSi.addMember("status") <<= status;
+    tmpSi.addMember("error") <<= error;
+    tmpSi.addMember("data") <<= dataHash;
+
+    return evalSha256(dto::srr::serializeJson(tmpSi, false));
+}
+
+std::string evalFeatureHash(const SrrFeature& feature)
+{
+    return evalFeatureHash(feature.m_feature_and_status.feature().version(),
+        dto::srr::statusToString(feature.m_feature_and_status.status().status()),
+        feature.m_feature_and_status.status().error(), evalSha256(feature.m_feature_and_status.feature().data()));
+}
+
+std::string evalFeatureHash(const SnapshotFeature& feature)
+{
+    return evalFeatureHash(feature.m_version, feature.m_status, feature.m_error, feature.m_hash);
+}
+
+std::map<std::string, std::string> evalFeatureHashes(const std::vector<Group>& groups)
+{
+    std::map<std::string, std::string> hashes;
+    for (const auto& group : groups) {
+        for (const auto& feature : group.m_features) {
+            hashes[feature.m_feature_name] = feature.m_ref.empty() ? evalFeatureHash(feature) : feature.m_ref;
+        }
+    }
+    return hashes;
+}
+
+std::map<std::string, std::string> evalFeatureHashes(const SnapshotManifest& manifest)
+{
+    std::map<std::string, std::string> hashes;
+    for (const auto& group : manifest.m_groups) {
+        for (const auto& feature : group.m_features) {
+            hashes[feature.m_name] = evalFeatureHash(feature);
+        }
+    }
+    return hashes;
+}
+
+void applyDelta(std::vector<Group>& groups, const std::vector<Group>& base)
+{
+    std::map<std::string, const SrrFeature*> baseFeatures;
+    for (const auto& group : base) {
+        for (const auto& feature : group.m_features) {
+            baseFeatures[feature.m_feature_name] = &feature;
+        }
+    }
+
+    for (auto& group : groups) {
+        for (auto& feature : group.m_features) {
+            if (feature.m_ref.empty()) {
+                continue;
+            }
+
+            auto found = baseFeatures.find(feature.m_feature_name);
+            if (found == baseFeatures.end() || !found->second->m_ref.empty()) {
+                throw SrrException("Base data of feature " + feature.m_feature_name + " not found");
+            }
+            if (evalFeatureHash(*found->second) != feature.m_ref) {
+                throw SrrException("Base data of feature " + feature.m_feature_name + " does not match its reference");
+            }
+            feature.m_feature_and_status = found->second->m_feature_and_status;
+            feature.m_ref.clear();
+        }
+    }
+}
+
 } // namespace srr
@@ -21,13 +21,33 @@
 
 #pragma once
 
+#include <map>
 #include <string>
+#include <vector>
 
 namespace srr {
 std::string evalSha256(const std::string& data);
 
 class Group;
+class SrrFeature;
+class SnapshotFeature;
+class SnapshotManifest;
 void evalDataIntegrity(Group& group);
 bool checkDataIntegrity(const Group& group);
 
+// hash of the feature (version, status and hash of the data), used to detect the unchanged features
+std::string evalFeatureHash(const SrrFeature& feature);
+
+// same hash for a feature of a stored snapshot, without reading its blob
+std::string evalFeatureHash(const SnapshotFeature& feature);
+
+// hashes of the features of a save, by feature name (references are kept as is)
+std::map<std::string, std::string> evalFeatureHashes(const std::vector<Group>& groups);
+
+// hashes of the features of a stored snapshot, by feature name
+std::map<std::string, std::string> evalFeatureHashes(const SnapshotManifest& manifest);
+
+// replace the data of the features which are references to a base save by the base data
+void applyDelta(std::vector<Group>& groups, const std::vector<Group>& base);
+
 } // namespace srr
@@ -0,0 +1,258 @@
+/*  =========================================================================
+    licensing - Cached licensing capabilities
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/licensing.h"
+#include <fty_common.h>
+#include <fty_common_mlm.h>
+#include <malamute.h>
+#include <sstream>
+
+#define LICENSING_AGENT_NAME   "etn-licensing"
+#define LICENSING_SUBJECT      "licensing"
+#define LICENSING_STREAM       "LICENSING-ANNOUNCEMENTS"
+#define LICENSING_TIMEOUT_SEC  5
+#define LICENSING_POLL_MSEC    1000
+
+namespace srr {
+
+void licenseActor(zsock_t* pipe, void* args);
+
+static std::string zmsg_popstring(zmsg_t* resp)
+{
+    char* popstr = zmsg_popstr(resp);
+    if (!popstr) {
+        return std::string();
+    }
+    // copies the null-terminated character sequence (C-string) pointed by popstr
+    std::string string_rv = popstr;
+    zstr_free(&popstr);
+    return string_rv;
+}
+
+static bool sendCapabilitiesRequest(mlm_client_t* client)
+{
+    zmsg_t* req = zmsg_new();
+    zmsg_addstr(req, "CAPABILITIES");
+    zmsg_addstr(req, "configurability");
+
+    if (mlm_client_sendto(client, LICENSING_AGENT_NAME, LICENSING_SUBJECT, nullptr, 1000, &req) != 0) {
+        zmsg_destroy(&req);
+        log_error("fty-srr: failed to send capabilities request to %s", LICENSING_AGENT_NAME);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Actor owning the licensing client
+ * @param pipe
+ * @param args LicenseCache instance
+ */
+void licenseActor(zsock_t* pipe, void* args)
+{
+    LicenseCache* cache = static_cast<LicenseCache*>(args);
+
+    mlm_client_t* client = mlm_client_new();
+    if (mlm_client_connect(client, cache->m_endpoint.c_str(), 1000, cache->m_clientName.c_str()) == -1) {
+        log_error("fty-srr: licensing client failed to connect to %s", cache->m_endpoint.c_str());
+    } else if (mlm_client_set_consumer(client, LICENSING_STREAM, ".*") == -1) {
+        log_warning("fty-srr: cannot listen to %s, licensing cache will rely on TTL only", LICENSING_STREAM);
+    }
+
+    zpoller_t* poller = zpoller_new(pipe, mlm_client_msgpipe(client), nullptr);
+    zsock_signal(pipe, 0);
+
+    bool                                  requestPending = false;
+    bool                                  requestStale   = false; // the license changed after the request was sent
+    std::chrono::steady_clock::time_point requestDeadline;
+
+    while (!zsys_interrupted) {
+        void* which = zpoller_wait(poller, LICENSING_POLL_MSEC);
+
+        if (which == pipe) {
+            zmsg_t*     msg     = zmsg_recv(pipe);
+            std::string command = zmsg_popstring(msg);
+            zmsg_destroy(&msg);
+
+            if (command == "$TERM") {
+                break;
+            } else if (command == "REFRESH" && !requestPending) {
+                requestPending  = sendCapabilitiesRequest(client);
+                requestDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(LICENSING_TIMEOUT_SEC);
+                if (!requestPending) {
+                    cache->update(false, false);
+                }
+            }
+        } else if (which == mlm_client_msgpipe(client)) {
+            zmsg_t*           msg     = mlm_client_recv(client);
+            const std::string command = mlm_client_command(client);
+
+            if (command == "STREAM DELIVER") {
+                // any licensing announcement may change the capabilities
+                log_debug("fty-srr: licensing announcement received, refreshing capabilities");
+                cache->invalidate();
+                if (requestPending) {
+                    requestStale = true;
+                } else {
+                    requestPending  = sendCapabilitiesRequest(client);
+                    requestDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(LICENSING_TIMEOUT_SEC);
+                }
+            } else if (command == "MAILBOX DELIVER" && requestPending &&
+                       (mlm_client_sender(client) != std::string(LICENSING_AGENT_NAME) ||
+                           mlm_client_subject(client) != std::string(LICENSING_SUBJECT))) {
+                log_warning("fty-srr: unexpected message from %s (subject %s) ignored", mlm_client_sender(client),
+                    mlm_client_subject(client));
+            } else if (command == "MAILBOX DELIVER" && requestPending && requestStale) {
+                // the reply may predate the license change, ask again
+                log_debug("fty-srr: licensing capabilities changed while requested, refreshing again");
+                requestStale    = false;
+                requestPending  = sendCapabilitiesRequest(client);
+                requestDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(LICENSING_TIMEOUT_SEC);
+                if (!requestPending) {
+                    cache->update(false, false);
+                }
+            } else if (command == "MAILBOX DELIVER" && requestPending) {
+                requestPending = false;
+
+                std::string reply = zmsg_popstring(msg);
+                std::string code  = zmsg_popstring(msg);
+                if (reply != "CAPABILITIES") {
+                    log_debug("fty-srr: Unknown command received");
+                    cache->update(false, false);
+                } else if (code != "OK") {
+                    log_debug("fty-srr: %s", code.c_str());
+                    cache->update(false, false);
+                } else {
+                    bool configurability = false;
+                    std::istringstream(zmsg_popstring(msg)) >> configurability;
+                    cache->update(true, configurability);
+                }
+            }
+            zmsg_destroy(&msg);
+        } else if (zpoller_terminated(poller)) {
+            break;
+        }
+
+        if (requestPending && std::chrono::steady_clock::now() > requestDeadline) {
+            log_error("fty-srr: %s did not answer (timeout = '%d')", LICENSING_AGENT_NAME, LICENSING_TIMEOUT_SEC);
+            requestPending = false;
+            requestStale   = false;
+            cache->update(false, false);
+        }
+
+        // refresh proactively once the cached value expired, so restores keep hitting the cache
+        bool expired = false;
+        {
+            std::lock_guard<std::mutex> lock(cache->m_mutex);
+            expired = cache->m_valid && !cache->isFresh();
+        }
+        if (expired && !requestPending) {
+            requestPending  = sendCapabilitiesRequest(client);
+            requestDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(LICENSING_TIMEOUT_SEC);
+        }
+    }
+
+    zpoller_destroy(&poller);
+    mlm_client_destroy(&client);
+}
+
+/**
+ * Constructor
+ * @param endpoint Malamute endpoint
+ * @param clientName Malamute client name used to talk to etn-licensing
+ * @param ttl Validity of a cached value
+ */
+LicenseCache::LicenseCache(const std::string& endpoint, const std::string& clientName, std::chrono::seconds ttl)
+    : m_endpoint(endpoint)
+    , m_clientName(clientName)
+    , m_ttl(ttl)
+{
+    m_actor = zactor_new(licenseActor, this);
+}
+
+LicenseCache::~LicenseCache()
+{
+    zactor_destroy(&m_actor);
+}
+
+void LicenseCache::prefetch()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_valid && isFresh()) {
+            return;
+        }
+    }
+    requestRefresh();
+}
+
+bool LicenseCache::isConfigurable(std::chrono::seconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_valid && isFresh()) {
+        return m_configurable;
+    }
+
+    const unsigned long generation = m_generation;
+    lock.unlock();
+    requestRefresh();
+    lock.lock();
+
+    if (!m_cv.wait_for(lock, timeout, [&]() {
+            return m_generation != generation;
+        })) {
+        log_error("fty-srr: licensing capabilities not available (timeout = '%d')", int(timeout.count()));
+        return false;
+    }
+
+    return m_valid && m_configurable;
+}
+
+void LicenseCache::invalidate()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_valid = false;
+}
+
+bool LicenseCache::isFresh() const
+{
+    return (Clock::now() - m_updated) < m_ttl;
+}
+
+void LicenseCache::requestRefresh()
+{
+    std::lock_guard<std::mutex> lock(m_actorMutex);
+    zstr_send(m_actor, "REFRESH");
+}
+
+void LicenseCache::update(bool valid, bool configurable)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_valid        = valid;
+        m_configurable = configurable;
+        m_updated      = Clock::now();
+        m_generation++;
+    }
+    m_cv.notify_all();
+}
+
+} // namespace srr
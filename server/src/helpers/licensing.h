@@ -0,0 +1,91 @@
+/*  =========================================================================
+    licensing - Cached licensing capabilities
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <czmq.h>
+#include <mutex>
+#include <string>
+
+namespace srr {
+
+/**
+ * Cache of the licensing "configurability" capability.
+ *
+ * A background actor owns a malamute client which queries etn-licensing when
+ * the cached value is missing or older than the TTL, and listens to the
+ * licensing announcements stream to drop the cached value as soon as the
+ * license changes. Callers only read the cache, and wait for the actor only
+ * when the cache is cold.
+ */
+class LicenseCache
+{
+public:
+    LicenseCache(const std::string& endpoint, const std::string& clientName, std::chrono::seconds ttl);
+    ~LicenseCache();
+
+    LicenseCache(const LicenseCache&) = delete;
+    LicenseCache& operator=(const LicenseCache&) = delete;
+
+    /**
+     * Ask for a refresh of the capability if the cache is cold, without waiting.
+     */
+    void prefetch();
+
+    /**
+     * Get the configurability capability.
+     * @param timeout Maximum time to wait for etn-licensing when the cache is cold
+     * @return True if configurability is allowed, false otherwise (or if licensing did not answer)
+     */
+    bool isConfigurable(std::chrono::seconds timeout = std::chrono::seconds(5));
+
+    /**
+     * Drop the cached value.
+     */
+    void invalidate();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    friend void licenseActor(zsock_t* pipe, void* args);
+
+    std::string          m_endpoint;
+    std::string          m_clientName;
+    std::chrono::seconds m_ttl;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    bool                    m_valid        = false;
+    bool                    m_configurable = false;
+    unsigned long           m_generation   = 0;
+    Clock::time_point       m_updated;
+
+    std::mutex m_actorMutex;
+    zactor_t*  m_actor = nullptr;
+
+    bool isFresh() const;
+    void requestRefresh();
+    void update(bool valid, bool configurable);
+};
+
+} // namespace srr
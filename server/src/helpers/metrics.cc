@@ -0,0 +1,277 @@
+/*  =========================================================================
+    metrics - Operation and agent request statistics
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/metrics.h"
+#include "fty_srr_groups.h"
+#include <cstdio>
+#include <fstream>
+#include <fty_common_dto.h>
+#include <fty_log.h>
+#include <sstream>
+
+#define METRICS_OTHER "other"
+
+namespace srr {
+
+void MetricsHistogram::observe(std::chrono::microseconds duration)
+{
+    const double seconds = std::chrono::duration<double>(duration).count();
+
+    size_t bucket = 0;
+    while (bucket < m_bounds.size() && seconds > m_bounds[bucket]) {
+        bucket++;
+    }
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumUs.fetch_add(static_cast<uint64_t>(duration.count()), std::memory_order_relaxed);
+}
+
+std::string MetricsHistogram::text(const std::string& name, const std::string& labels) const
+{
+    std::ostringstream out;
+    const std::string  separator = labels.empty() ? "" : ",";
+
+    uint64_t cumulated = 0;
+    for (size_t i = 0; i < m_buckets.size(); i++) {
+        cumulated += m_buckets[i].load(std::memory_order_relaxed);
+        out << name << "_bucket{" << labels << separator << "le=\"";
+        if (i < m_bounds.size()) {
+            out << m_bounds[i];
+        } else {
+            out << "+Inf";
+        }
+        out << "\"} " << cumulated << "\n";
+    }
+    out << name << "_sum{" << labels << "} " << double(m_sumUs.load(std::memory_order_relaxed)) / 1e6 << "\n";
+    out << name << "_count{" << labels << "} " << m_count.load(std::memory_order_relaxed) << "\n";
+
+    return out.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Metrics::Metrics()
+{
+    for (const auto& operation : {"list", "save", "restore", "reset", METRICS_OTHER}) {
+        for (auto status : {dto::srr::Status::UNKNOWN, dto::srr::Status::SUCCESS, dto::srr::Status::FAILED,
+                 dto::srr::Status::PARTIAL_SUCCESS}) {
+            m_operations[operation][dto::srr::statusToString(status)];
+        }
+        m_operations[operation][METRICS_OTHER];
+        m_operationDuration[operation];
+    }
+
+    auto initAgent = [&](const std::string& queue) {
+        for (const auto& action : {"save", "restore", "reset", METRICS_OTHER}) {
+            m_agents[queue].m_requests[action];
+        }
+    };
+    for (const auto& agent : g_agentToQueue) {
+        initAgent(agent.second);
+    }
+    initAgent(METRICS_OTHER);
+}
+
+Metrics& Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+template <typename Map>
+static typename Map::mapped_type& find(Map& map, const std::string& key)
+{
+    auto found = map.find(key);
+    return found != map.end() ? found->second : map.at(METRICS_OTHER);
+}
+
+Metrics::AgentMetrics& Metrics::agent(const std::string& queue)
+{
+    return find(m_agents, queue);
+}
+
+void Metrics::operation(const std::string& operation, const std::string& status, std::chrono::microseconds duration)
+{
+    find(find(m_operations, operation), status).fetch_add(1, std::memory_order_relaxed);
+    find(m_operationDuration, operation).observe(duration);
+}
+
+void Metrics::agentRequest(const std::string& queue, const std::string& action, std::chrono::microseconds duration,
+    uint64_t bytesSent, uint64_t bytesReceived)
+{
+    AgentMetrics& metrics = agent(queue);
+    find(metrics.m_requests, action).fetch_add(1, std::memory_order_relaxed);
+    metrics.m_bytesSent.fetch_add(bytesSent, std::memory_order_relaxed);
+    metrics.m_bytesReceived.fetch_add(bytesReceived, std::memory_order_relaxed);
+    metrics.m_duration.observe(duration);
+}
+
+void Metrics::agentTimeout(const std::string& queue)
+{
+    agent(queue).m_timeouts.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::agentError(const std::string& queue)
+{
+    agent(queue).m_errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::integrityFailure()
+{
+    m_integrityFailures.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::rollback()
+{
+    m_rollbacks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::reboot()
+{
+    m_reboots.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::saveCache(bool hit)
+{
+    (hit ? m_saveCacheHits : m_saveCacheMisses).fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::saveCoalesced()
+{
+    m_saveCoalesced.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void header(std::ostream& out, const std::string& name, const std::string& type, const std::string& help)
+{
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+std::string Metrics::prometheusText() const
+{
+    std::ostringstream out;
+
+    header(out, "srr_operations_total", "counter", "Operations handled, by type and status");
+    for (const auto& operation : m_operations) {
+        for (const auto& status : operation.second) {
+            out << "srr_operations_total{operation=\"" << operation.first << "\",status=\"" << status.first << "\"} "
+                << status.second.load(std::memory_order_relaxed) << "\n";
+        }
+    }
+
+    header(out, "srr_operation_duration_seconds", "histogram", "Duration of the operations");
+    for (const auto& operation : m_operationDuration) {
+        out << operation.second.text("srr_operation_duration_seconds", "operation=\"" + operation.first + "\"");
+    }
+
+    header(out, "srr_agent_requests_total", "counter", "Requests sent to the agents, by queue and action");
+    for (const auto& agent : m_agents) {
+        for (const auto& action : agent.second.m_requests) {
+            out << "srr_agent_requests_total{queue=\"" << agent.first << "\",action=\"" << action.first << "\"} "
+                << action.second.load(std::memory_order_relaxed) << "\n";
+        }
+    }
+
+    header(out, "srr_agent_request_duration_seconds", "histogram", "Duration of the requests sent to the agents");
+    for (const auto& agent : m_agents) {
+        out << agent.second.m_duration.text("srr_agent_request_duration_seconds", "queue=\"" + agent.first + "\"");
+    }
+
+    const std::map<std::string, std::pair<std::string, const Counter AgentMetrics::*>> agentCounters = {
+        {"srr_agent_timeouts_total", {"Requests to the agents which timed out", &AgentMetrics::m_timeouts}},
+        {"srr_agent_errors_total", {"Requests to the agents which failed", &AgentMetrics::m_errors}},
+        {"srr_agent_sent_bytes_total", {"Bytes sent to the agents", &AgentMetrics::m_bytesSent}},
+        {"srr_agent_received_bytes_total", {"Bytes received from the agents", &AgentMetrics::m_bytesReceived}}};
+
+    for (const auto& counter : agentCounters) {
+        header(out, counter.first, "counter", counter.second.first);
+        for (const auto& agent : m_agents) {
+            out << counter.first << "{queue=\"" << agent.first << "\"} "
+                << (agent.second.*(counter.second.second)).load(std::memory_order_relaxed) << "\n";
+        }
+    }
+
+    header(out, "srr_integrity_failures_total", "counter", "Groups rejected by the data integrity check");
+    out << "srr_integrity_failures_total " << m_integrityFailures.load(std::memory_order_relaxed) << "\n";
+
+    header(out, "srr_rollbacks_total", "counter", "Rollbacks after a failed restore");
+    out << "srr_rollbacks_total " << m_rollbacks.load(std::memory_order_relaxed) << "\n";
+
+    header(out, "srr_reboots_total", "counter", "Reboots requested after a restore");
+    out << "srr_reboots_total " << m_reboots.load(std::memory_order_relaxed) << "\n";
+
+    header(out, "srr_save_cache_lookups_total", "counter", "Features looked up in the save cache, by result");
+    out << "srr_save_cache_lookups_total{result=\"hit\"} " << m_saveCacheHits.load(std::memory_order_relaxed) << "\n";
+    out << "srr_save_cache_lookups_total{result=\"miss\"} " << m_saveCacheMisses.load(std::memory_order_relaxed)
+        << "\n";
+
+    header(out, "srr_save_coalesced_total", "counter", "Feature saves shared with an identical save in flight");
+    out << "srr_save_coalesced_total " << m_saveCoalesced.load(std::memory_order_relaxed) << "\n";
+
+    return out.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MetricsFileWriter::MetricsFileWriter(const std::string& path, std::chrono::seconds period)
+    : m_path(path)
+    , m_period(period)
+{
+    m_thread = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_cv.wait_for(lock, m_period, [this]() {
+            return m_stop;
+        })) {
+            write();
+        }
+    });
+}
+
+MetricsFileWriter::~MetricsFileWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+
+    write();
+}
+
+void MetricsFileWriter::write() const
+{
+    // write then rename, so that readers never see a partial file
+    const std::string tmpPath = m_path + ".tmp";
+    {
+        std::ofstream file(tmpPath);
+        file << Metrics::instance().prometheusText();
+        if (!file) {
+            log_error("Failed to write metrics file %s", tmpPath.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), m_path.c_str()) != 0) {
+        log_error("Failed to write metrics file %s", m_path.c_str());
+    }
+}
+
+} // namespace srr
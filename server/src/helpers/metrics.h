@@ -0,0 +1,134 @@
+/*  =========================================================================
+    metrics - Operation and agent request statistics
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace srr {
+
+class MetricsHistogram
+{
+public:
+    // upper bounds of the buckets, in seconds (last bucket is +Inf)
+    static constexpr std::array<double, 14> m_bounds = {
+        0.005, 0.01, 0.05, 0.1, 0.5, 1, 5, 10, 30, 60, 120, 300, 600, 1800};
+
+    void observe(std::chrono::microseconds duration);
+
+    // Prometheus text of the histogram, labels being already formatted (ex: operation="save")
+    std::string text(const std::string& name, const std::string& labels) const;
+
+private:
+    std::array<std::atomic<uint64_t>, m_bounds.size() + 1> m_buckets{};
+    std::atomic<uint64_t>                                    m_count{0};
+    std::atomic<uint64_t>                                    m_sumUs{0};
+};
+
+/**
+ * Statistics of the daemon.
+ *
+ * All the label combinations are created at construction (unknown label
+ * values are accounted as "other"), so the maps are never modified
+ * afterwards and updating a metric is a relaxed atomic increment.
+ */
+class Metrics
+{
+public:
+    static Metrics& instance();
+
+    void operation(const std::string& operation, const std::string& status, std::chrono::microseconds duration);
+    void agentRequest(const std::string& queue, const std::string& action, std::chrono::microseconds duration,
+        uint64_t bytesSent, uint64_t bytesReceived);
+    void agentTimeout(const std::string& queue);
+    void agentError(const std::string& queue);
+    void integrityFailure();
+    void rollback();
+    void reboot();
+    void saveCache(bool hit);
+    void saveCoalesced();
+
+    // statistics in the Prometheus text exposition format
+    std::string prometheusText() const;
+
+private:
+    using Counter = std::atomic<uint64_t>;
+
+    struct AgentMetrics
+    {
+        std::map<std::string, Counter> m_requests; // by action
+        Counter                        m_timeouts{0};
+        Counter                        m_errors{0};
+        Counter                        m_bytesSent{0};
+        Counter                        m_bytesReceived{0};
+        MetricsHistogram               m_duration;
+    };
+
+    Metrics();
+
+    std::map<std::string, std::map<std::string, Counter>> m_operations; // by operation, then status
+    std::map<std::string, MetricsHistogram>               m_operationDuration;
+    std::map<std::string, AgentMetrics>                   m_agents; // by queue
+
+    Counter m_integrityFailures{0};
+    Counter m_rollbacks{0};
+    Counter m_reboots{0};
+    Counter m_saveCacheHits{0};
+    Counter m_saveCacheMisses{0};
+    Counter m_saveCoalesced{0};
+
+    AgentMetrics& agent(const std::string& queue);
+};
+
+/**
+ * Periodically write the metrics in a file, for the node exporter textfile collector.
+ */
+class MetricsFileWriter
+{
+public:
+    MetricsFileWriter(const std::string& path, std::chrono::seconds period);
+    ~MetricsFileWriter();
+
+    MetricsFileWriter(const MetricsFileWriter&) = delete;
+    MetricsFileWriter& operator=(const MetricsFileWriter&) = delete;
+
+    void write() const;
+
+private:
+    std::string          m_path;
+    std::chrono::seconds m_period;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    bool                    m_stop = false;
+    std::thread             m_thread;
+};
+
+} // namespace srr
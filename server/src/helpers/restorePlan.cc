@@ -0,0 +1,307 @@
+/*  =========================================================================
+    restorePlan - Compilation and estimate of the restore plans
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/restorePlan.h"
+#include "fty_srr_groups.h"
+#include <algorithm>
+#include <fty_log.h>
+#include <map>
+
+// estimate of an agent query when no latency was recorded yet
+#define PLAN_DEFAULT_STEP_MS 1000
+// percentile of the recorded latencies used for the estimate
+#define PLAN_LATENCY_PERCENTILE 0.5
+
+namespace srr {
+RestoreSelection::RestoreSelection(const std::vector<std::string>& include, const std::vector<std::string>& exclude)
+    : m_include(include.begin(), include.end())
+    , m_exclude(exclude.begin(), exclude.end())
+{
+    for (const auto& names : {m_include, m_exclude}) {
+        for (const auto& name : names) {
+            if (g_srrGroupMap.find(name) == g_srrGroupMap.end() &&
+                g_srrFeatureMap.find(name) == g_srrFeatureMap.end()) {
+                throw std::runtime_error("Unknown group or feature " + name);
+            }
+        }
+    }
+}
+
+bool RestoreSelection::all() const
+{
+    return m_include.empty() && m_exclude.empty();
+}
+
+bool RestoreSelection::isSelected(const std::string& groupId, const std::string& featureName) const
+{
+    if (m_exclude.count(groupId) || m_exclude.count(featureName)) {
+        return false;
+    }
+    return m_include.empty() || m_include.count(groupId) || m_include.count(featureName);
+}
+
+bool RestoreSelection::isSelected(const std::string& groupId) const
+{
+    auto groupIt = g_srrGroupMap.find(groupId);
+    if (groupIt == g_srrGroupMap.end()) {
+        // unknown group, only its id can select it
+        return !m_exclude.count(groupId) && (m_include.empty() || m_include.count(groupId));
+    }
+    const auto& featureList = groupIt->second.m_fp;
+    return std::any_of(featureList.begin(), featureList.end(), [&](const SrrFeaturePriorityStruct& fp) {
+        return isSelected(groupId, fp.m_feature);
+    });
+}
+
+std::vector<PlanStep> compileRestoreSteps(std::vector<std::string> features)
+{
+    std::stable_sort(features.begin(), features.end(), [](const std::string& l, const std::string& r) {
+        return getPriority(l) < getPriority(r);
+    });
+
+    std::vector<PlanStep> steps;
+    for (const auto& featureName : features) {
+        const auto& agent = g_srrFeatureMap.at(featureName).m_agent;
+
+        // the consecutive features of a same priority and a same agent share one query and one settle delay
+        if (!steps.empty() && steps.back().m_agent == agent &&
+            getPriority(steps.back().m_features.back()) == getPriority(featureName)) {
+            steps.back().m_features.push_back(featureName);
+        } else {
+            PlanStep step;
+            step.m_agent = agent;
+            step.m_features.push_back(featureName);
+            steps.push_back(step);
+        }
+    }
+    return steps;
+}
+
+RestorePlan compileRestorePlan(const std::vector<Group>& groups, const std::string& version,
+    const std::set<std::string>& unresponsiveAgents, const RestoreSelection& selection)
+{
+    RestorePlan plan;
+
+    for (const auto& group : groups) {
+        const auto& groupId = group.m_group_id;
+
+        if (!selection.isSelected(groupId)) {
+            continue;
+        }
+
+        GroupPlan groupPlan;
+        groupPlan.m_group_id = groupId;
+
+        auto groupIt = g_srrGroupMap.find(groupId);
+        if (groupIt == g_srrGroupMap.end()) {
+            groupPlan.m_error = TRANSLATE_ME("Group %s is not supported. Will not be restored", groupId.c_str());
+            plan.m_groups.push_back(groupPlan);
+            continue;
+        }
+
+        // only the selected features of the group are backed up, reset and restored
+        std::vector<SrrFeaturePriorityStruct> featureList;
+        for (const auto& feature : groupIt->second.m_fp) {
+            if (selection.isSelected(groupId, feature.m_feature)) {
+                featureList.push_back(feature);
+            }
+        }
+
+        std::set<std::string> payloadFeatures;
+        for (const auto& feature : group.m_features) {
+            payloadFeatures.insert(feature.m_feature_name);
+        }
+
+        // a feature required in the payload version must be there, whatever the state of the other groups
+        bool                  unknownFeature = false;
+        std::set<std::string> groupUnresponsiveAgents;
+        for (const auto& feature : featureList) {
+            auto featureIt = g_srrFeatureMap.find(feature.m_feature);
+            if (featureIt == g_srrFeatureMap.end()) {
+                unknownFeature = true;
+                continue;
+            }
+            if (unresponsiveAgents.count(featureIt->second.m_agent)) {
+                groupUnresponsiveAgents.insert(featureIt->second.m_agent);
+            }
+
+            const auto& requiredIn = featureIt->second.m_requiredIn;
+            if (!payloadFeatures.count(feature.m_feature) &&
+                std::find(requiredIn.begin(), requiredIn.end(), version) != requiredIn.end()) {
+                log_error("Feature %s is required in version %s", feature.m_feature.c_str(), version.c_str());
+                throw std::runtime_error("Feature " + feature.m_feature + " is required in version " + version);
+            }
+        }
+
+        if (!groupUnresponsiveAgents.empty()) {
+            std::string agents;
+            for (const auto& agent : groupUnresponsiveAgents) {
+                agents += (agents.empty() ? "" : ", ") + agent;
+            }
+            groupPlan.m_error = TRANSLATE_ME(
+                "Group %s not restored: agents not responding (%s)", groupId.c_str(), agents.c_str());
+            plan.m_groups.push_back(groupPlan);
+            continue;
+        }
+        if (unknownFeature) {
+            groupPlan.m_error = TRANSLATE_ME("Group %s cannot be restored. Missing features", groupId.c_str());
+            plan.m_groups.push_back(groupPlan);
+            continue;
+        }
+
+        // save the current state of all the features of the group, for the rollback
+        for (const auto& feature : featureList) {
+            PlanStep step;
+            step.m_agent = g_srrFeatureMap.at(feature.m_feature).m_agent;
+            step.m_features.push_back(feature.m_feature);
+            groupPlan.m_backup.push_back(step);
+        }
+
+        // reset in reverse order, one query per agent
+        std::map<std::string, PlanStep> resetSteps;
+        for (auto revIt = featureList.rbegin(); revIt != featureList.rend(); revIt++) {
+            const auto& featureInfo = g_srrFeatureMap.at(revIt->m_feature);
+            if (featureInfo.m_reset) {
+                PlanStep& step = resetSteps[featureInfo.m_agent];
+                step.m_agent   = featureInfo.m_agent;
+                step.m_features.push_back(revIt->m_feature);
+            }
+        }
+        for (const auto& step : resetSteps) {
+            groupPlan.m_reset.push_back(step.second);
+        }
+
+        // restore the features of the payload in priority order
+        std::vector<std::string> restoreFeatures;
+        for (const auto& feature : group.m_features) {
+            const auto& featureName = feature.m_feature_name;
+            if (std::find(restoreFeatures.begin(), restoreFeatures.end(), featureName) != restoreFeatures.end()) {
+                continue;
+            }
+            auto found = std::find_if(featureList.begin(), featureList.end(), [&](const SrrFeaturePriorityStruct& fp) {
+                return fp.m_feature == featureName;
+            });
+            if (found == featureList.end()) {
+                if (selection.all()) {
+                    log_warning("Feature %s is not part of group %s, it will not be restored", featureName.c_str(),
+                        groupId.c_str());
+                }
+                continue;
+            }
+            restoreFeatures.push_back(featureName);
+        }
+        groupPlan.m_restore = compileRestoreSteps(restoreFeatures);
+        for (const auto& step : groupPlan.m_restore) {
+            for (const auto& featureName : step.m_features) {
+                if (g_srrFeatureMap.at(featureName).m_restart) {
+                    groupPlan.m_reload.push_back(featureName);
+                    plan.m_reboot = true;
+                }
+            }
+        }
+
+        plan.m_groups.push_back(groupPlan);
+    }
+
+    // restore order, the unknown groups at the end
+    std::stable_sort(plan.m_groups.begin(), plan.m_groups.end(), [](const GroupPlan& l, const GroupPlan& r) {
+        auto lIt = g_srrGroupMap.find(l.m_group_id);
+        auto rIt = g_srrGroupMap.find(r.m_group_id);
+        if (lIt == g_srrGroupMap.end() || rIt == g_srrGroupMap.end()) {
+            return lIt != g_srrGroupMap.end() && rIt == g_srrGroupMap.end();
+        }
+        return lIt->second.m_restoreOrder < rIt->second.m_restoreOrder;
+    });
+
+    return plan;
+}
+
+static uint64_t estimateStepMs(PlanStep& step, AgentOperation op, const AgentLatencyTracker& latency)
+{
+    step.m_estimated_ms = PLAN_DEFAULT_STEP_MS;
+
+    auto queue = g_agentToQueue.find(step.m_agent);
+    if (queue != g_agentToQueue.end() && latency.samples(queue->second, op) > 0) {
+        step.m_estimated_ms =
+            static_cast<uint64_t>(latency.percentile(queue->second, op, PLAN_LATENCY_PERCENTILE).count());
+    }
+    return step.m_estimated_ms;
+}
+
+bool canOverlapBackup(const GroupPlan& restored, const GroupPlan& next)
+{
+    std::set<std::string> agents;
+    for (const auto& steps : {restored.m_reset, restored.m_restore}) {
+        for (const auto& step : steps) {
+            agents.insert(step.m_agent);
+        }
+    }
+    return std::none_of(next.m_backup.begin(), next.m_backup.end(), [&](const PlanStep& step) {
+        return agents.count(step.m_agent) != 0;
+    });
+}
+
+void estimateRestorePlan(RestorePlan& plan, const AgentLatencyTracker& latency, std::chrono::milliseconds settleDelay)
+{
+    // the backup of a group runs while the previous group is restored, unless they share agents
+    // (see SrrWorker::executeRestorePlan)
+    uint64_t         total         = 0;
+    uint64_t         previousStage = 0;
+    const GroupPlan* previous      = nullptr;
+
+    for (auto& group : plan.m_groups) {
+        if (!group.m_error.empty()) {
+            group.m_estimated_ms = 0;
+            continue;
+        }
+
+        uint64_t backupMs = 0;
+        for (auto& step : group.m_backup) {
+            backupMs += estimateStepMs(step, AgentOperation::SAVE, latency);
+        }
+        // the agents are reset concurrently
+        uint64_t resetMs = 0;
+        for (auto& step : group.m_reset) {
+            resetMs = std::max(resetMs, estimateStepMs(step, AgentOperation::RESET, latency));
+        }
+        uint64_t restoreMs = 0;
+        for (auto& step : group.m_restore) {
+            restoreMs += estimateStepMs(step, AgentOperation::RESTORE, latency) +
+                         static_cast<uint64_t>(settleDelay.count());
+        }
+
+        group.m_estimated_ms = backupMs + resetMs + restoreMs;
+
+        if (!previous) {
+            total += backupMs;
+        } else if (canOverlapBackup(*previous, group)) {
+            total += std::max(previousStage, backupMs);
+        } else {
+            total += previousStage + backupMs;
+        }
+        previous      = &group;
+        previousStage = resetMs + restoreMs;
+    }
+
+    plan.m_estimated_ms = total + previousStage;
+}
+
+} // namespace srr
@@ -0,0 +1,93 @@
+/*  =========================================================================
+    restorePlan - Compilation and estimate of the restore plans
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include "dto/common.h"
+#include "dto/plan.h"
+#include "helpers/agentLatency.h"
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace srr {
+/**
+ * Part of the payload to restore, by group id or feature name.
+ * Everything is selected when the include list is empty, the exclude list wins.
+ */
+class RestoreSelection
+{
+public:
+    RestoreSelection() = default;
+    /**
+     * @throw std::runtime_error if a name is neither a group nor a feature
+     */
+    RestoreSelection(const std::vector<std::string>& include, const std::vector<std::string>& exclude);
+
+    bool all() const;
+
+    bool isSelected(const std::string& groupId, const std::string& featureName) const;
+    // at least one feature of the group is selected
+    bool isSelected(const std::string& groupId) const;
+
+private:
+    std::set<std::string> m_include;
+    std::set<std::string> m_exclude;
+};
+
+/**
+ * Compile the restore steps of features
+ * @param features Features to restore
+ * @return The steps in priority order, the consecutive features of a same priority and a same agent in one step
+ */
+std::vector<PlanStep> compileRestoreSteps(std::vector<std::string> features);
+
+/**
+ * Compile the plan of a restore, before any agent is contacted
+ * @param groups Groups of the restore payload
+ * @param version Version of the restore payload, to check the required features
+ * @param unresponsiveAgents Agents which failed the preflight, their groups are skipped
+ * @param selection Features to restore, the others are left untouched
+ * @return The plan, the groups in restore order and the features in priority order
+ * @throw std::runtime_error if a selected feature required in the payload version is missing
+ */
+RestorePlan compileRestorePlan(const std::vector<Group>& groups, const std::string& version,
+    const std::set<std::string>& unresponsiveAgents, const RestoreSelection& selection = RestoreSelection());
+
+/**
+ * Check if the backup of a group can run while the previous group is reset and restored
+ * @param restored Group being reset and restored
+ * @param next Group to back up
+ * @return False if an agent of the backup takes part in the reset or restore, the backup then waits for the
+ * restored group to settle
+ */
+bool canOverlapBackup(const GroupPlan& restored, const GroupPlan& next);
+
+/**
+ * Estimate the duration of the steps of a plan from the recorded agent latencies
+ * @param plan
+ * @param latency
+ * @param settleDelay Delay after each feature restore
+ */
+void estimateRestorePlan(RestorePlan& plan, const AgentLatencyTracker& latency, std::chrono::milliseconds settleDelay);
+
+} // namespace srr
@@ -0,0 +1,280 @@
+/*  =========================================================================
+    saveCache - Cache of the saved features, refreshed on change events
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/saveCache.h"
+#include "fty_srr_groups.h"
+#include "helpers/data_integrity.h"
+#include "helpers/metrics.h"
+#include <fty_common.h>
+#include <fty_common_mlm.h>
+#include <malamute.h>
+#include <vector>
+
+#define SAVE_CACHE_POLL_MSEC 1000
+
+namespace srr {
+
+void saveCacheActor(zsock_t* pipe, void* args);
+
+/**
+ * Actor listening to the configuration change stream
+ * @param pipe
+ * @param args SaveCache instance
+ */
+void saveCacheActor(zsock_t* pipe, void* args)
+{
+    SaveCache* cache = static_cast<SaveCache*>(args);
+
+    mlm_client_t* client = mlm_client_new();
+    if (mlm_client_connect(client, cache->m_endpoint.c_str(), 1000, cache->m_clientName.c_str()) == -1) {
+        log_error("fty-srr: save cache client failed to connect to %s", cache->m_endpoint.c_str());
+    } else if (mlm_client_set_consumer(client, cache->m_stream.c_str(), ".*") == -1) {
+        log_warning("fty-srr: cannot listen to %s, save cache will rely on TTL only", cache->m_stream.c_str());
+    }
+
+    zpoller_t* poller = zpoller_new(pipe, mlm_client_msgpipe(client), nullptr);
+    zsock_signal(pipe, 0);
+
+    while (!zsys_interrupted) {
+        void* which = zpoller_wait(poller, SAVE_CACHE_POLL_MSEC);
+
+        if (which == pipe) {
+            zmsg_t* msg     = zmsg_recv(pipe);
+            char*   command = zmsg_popstr(msg);
+            zmsg_destroy(&msg);
+
+            const bool term = command && streq(command, "$TERM");
+            zstr_free(&command);
+            if (term) {
+                break;
+            }
+        } else if (which == mlm_client_msgpipe(client)) {
+            zmsg_t* msg = mlm_client_recv(client);
+            if (streq(mlm_client_command(client), "STREAM DELIVER")) {
+                // the subject is the name of the changed feature, or of the agent owning it
+                const std::string subject = mlm_client_subject(client);
+                log_debug("fty-srr: change of %s received, invalidating the cached features", subject.c_str());
+                cache->invalidate(subject);
+            }
+            zmsg_destroy(&msg);
+        } else if (zpoller_terminated(poller)) {
+            break;
+        }
+    }
+
+    zpoller_destroy(&poller);
+    mlm_client_destroy(&client);
+}
+
+SaveCache::SaveCache(const std::string& endpoint, const std::string& clientName, const std::string& stream,
+    std::chrono::seconds ttl, SaveFunction save)
+    : m_endpoint(endpoint)
+    , m_clientName(clientName)
+    , m_stream(stream)
+    , m_ttl(ttl)
+    , m_save(save)
+{
+    if (!m_stream.empty()) {
+        m_actor = zactor_new(saveCacheActor, this);
+    }
+    m_refreshThread = std::thread(&SaveCache::refreshLoop, this);
+}
+
+SaveCache::~SaveCache()
+{
+    if (m_actor) {
+        zactor_destroy(&m_actor);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_refreshThread.join();
+}
+
+std::string SaveCache::key(const std::string& passphrase, const std::string& sessionToken)
+{
+    // do not keep the credentials in the key
+    return evalSha256(passphrase + "/" + sessionToken);
+}
+
+bool SaveCache::isStale(const dto::srr::FeatureName& featureName, const Entry& entry) const
+{
+    auto generation = m_generations.find(featureName);
+    return (generation != m_generations.end() && generation->second != entry.m_generation) ||
+           Clock::now() - entry.m_updated >= m_ttl;
+}
+
+bool SaveCache::get(const dto::srr::FeatureName& featureName, const std::string& passphrase,
+    const std::string& sessionToken, dto::srr::SaveResponse& save)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto credentials = m_entries.find(key(passphrase, sessionToken));
+    if (credentials != m_entries.end()) {
+        auto entry = credentials->second.m_features.find(featureName);
+        if (entry != credentials->second.m_features.end() && !isStale(featureName, entry->second)) {
+            save                 = entry->second.m_save;
+            entry->second.m_used = Clock::now();
+            Metrics::instance().saveCache(true);
+            return true;
+        }
+    }
+    Metrics::instance().saveCache(false);
+    return false;
+}
+
+unsigned long SaveCache::generation(const dto::srr::FeatureName& featureName)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto found = m_generations.find(featureName);
+    return found == m_generations.end() ? 0 : found->second;
+}
+
+void SaveCache::put(const dto::srr::FeatureName& featureName, const std::string& passphrase,
+    const std::string& sessionToken, const dto::srr::SaveResponse& save, unsigned long generation)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto current = m_generations.find(featureName);
+    if (current != m_generations.end() && current->second != generation) {
+        log_debug("fty-srr: %s changed while being saved, not cached", featureName.c_str());
+        return;
+    }
+
+    Credentials& credentials   = m_entries[key(passphrase, sessionToken)];
+    credentials.m_passphrase   = passphrase;
+    credentials.m_sessionToken = sessionToken;
+
+    Entry& entry       = credentials.m_features[featureName];
+    entry.m_save       = save;
+    entry.m_updated    = Clock::now();
+    entry.m_used       = entry.m_updated;
+    entry.m_generation = generation;
+}
+
+void SaveCache::invalidate(const std::string& name)
+{
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // the generation of a feature not cached yet moves too, for the saves in flight
+        m_generations[name]++;
+        for (const auto& feature : g_srrFeatureMap) {
+            if (feature.first != name && feature.second.m_agent == name) {
+                m_generations[feature.first]++;
+            }
+        }
+
+        for (const auto& credentials : m_entries) {
+            for (const auto& feature : credentials.second.m_features) {
+                auto info = g_srrFeatureMap.find(feature.first);
+                if (feature.first == name || (info != g_srrFeatureMap.end() && info->second.m_agent == name)) {
+                    found = true;
+                }
+            }
+        }
+    }
+    if (found) {
+        m_cv.notify_all();
+    }
+}
+
+void SaveCache::refreshLoop()
+{
+    struct Refresh
+    {
+        std::string           m_key;
+        dto::srr::FeatureName m_featureName;
+        std::string           m_passphrase;
+        std::string           m_sessionToken;
+        unsigned long         m_generation;
+    };
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        // features made stale by an event, or too old, the unused ones being dropped with their credentials
+        std::vector<Refresh> refreshes;
+        for (auto credentials = m_entries.begin(); credentials != m_entries.end();) {
+            auto& features = credentials->second.m_features;
+            for (auto feature = features.begin(); feature != features.end();) {
+                if (Clock::now() - feature->second.m_used >= m_ttl) {
+                    feature = features.erase(feature);
+                    continue;
+                }
+                if (isStale(feature->first, feature->second)) {
+                    auto generation = m_generations.find(feature->first);
+                    refreshes.push_back({credentials->first, feature->first, credentials->second.m_passphrase,
+                        credentials->second.m_sessionToken,
+                        generation == m_generations.end() ? 0 : generation->second});
+                }
+                ++feature;
+            }
+            if (features.empty()) {
+                credentials = m_entries.erase(credentials);
+            } else {
+                ++credentials;
+            }
+        }
+
+        if (refreshes.empty()) {
+            m_cv.wait_for(lock, m_ttl);
+            continue;
+        }
+
+        lock.unlock();
+        for (const auto& refresh : refreshes) {
+            dto::srr::SaveResponse save;
+            bool                   saved = false;
+            try {
+                save  = m_save(refresh.m_featureName, refresh.m_passphrase, refresh.m_sessionToken);
+                saved = true;
+            } catch (const std::exception& e) {
+                log_warning("fty-srr: background save of %s failed: %s", refresh.m_featureName.c_str(), e.what());
+            }
+
+            std::lock_guard<std::mutex> refreshLock(m_mutex);
+            auto credentials = m_entries.find(refresh.m_key);
+            if (credentials == m_entries.end()) {
+                continue;
+            }
+            auto entry = credentials->second.m_features.find(refresh.m_featureName);
+            if (entry == credentials->second.m_features.end()) {
+                continue;
+            }
+            if (!saved) {
+                // next save will call the agent
+                credentials->second.m_features.erase(entry);
+            } else if (m_generations[refresh.m_featureName] == refresh.m_generation) {
+                // not changed again while being saved
+                entry->second.m_save       = save;
+                entry->second.m_updated    = Clock::now();
+                entry->second.m_generation = refresh.m_generation;
+            }
+        }
+        lock.lock();
+    }
+}
+
+} // namespace srr
@@ -0,0 +1,134 @@
+/*  =========================================================================
+    saveCache - Cache of the saved features, refreshed on change events
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <czmq.h>
+#include <fty_common_dto.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace srr {
+
+/**
+ * Cache of the saved features.
+ *
+ * The features saved by the agents are kept in memory, per passphrase and
+ * session token (the agents encrypt the sensitive data with the passphrase and
+ * check the token). A background actor listens to the configuration change
+ * stream: a message whose subject is a feature name or an agent name makes the
+ * cached features stale, and a background thread saves them again with the
+ * credentials of their last save. A save then only calls the agents for the
+ * stale features. The features which no save used within the TTL are dropped
+ * with their credentials instead of being refreshed.
+ */
+class SaveCache
+{
+public:
+    using SaveFunction = std::function<dto::srr::SaveResponse(
+        const dto::srr::FeatureName& featureName, const std::string& passphrase, const std::string& sessionToken)>;
+
+    /**
+     * Constructor
+     * @param endpoint Malamute endpoint
+     * @param clientName Malamute client name used to listen to the change stream
+     * @param stream Configuration change stream (none if empty, the features then only expire)
+     * @param ttl Maximum age of a cached feature, even without change event
+     * @param save Function saving a feature (called from the refresh thread)
+     */
+    SaveCache(const std::string& endpoint, const std::string& clientName, const std::string& stream,
+        std::chrono::seconds ttl, SaveFunction save);
+    ~SaveCache();
+
+    SaveCache(const SaveCache&) = delete;
+    SaveCache& operator=(const SaveCache&) = delete;
+
+    /**
+     * Get a fresh cached feature
+     * @return False if the feature is not cached with these credentials or is stale
+     */
+    bool get(const dto::srr::FeatureName& featureName, const std::string& passphrase, const std::string& sessionToken,
+        dto::srr::SaveResponse& save);
+
+    // changes of a feature so far, to be taken before calling the agent and given back to put
+    unsigned long generation(const dto::srr::FeatureName& featureName);
+
+    /**
+     * Cache a feature saved by the agent
+     * @param generation Generation of the feature taken before the agent call: the save is not cached if the
+     * feature changed meanwhile, the data being possibly older than the change
+     */
+    void put(const dto::srr::FeatureName& featureName, const std::string& passphrase, const std::string& sessionToken,
+        const dto::srr::SaveResponse& save, unsigned long generation);
+
+    // make stale the features matching a feature or an agent name
+    void invalidate(const std::string& name);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    friend void saveCacheActor(zsock_t* pipe, void* args);
+
+    struct Entry
+    {
+        dto::srr::SaveResponse m_save;
+        Clock::time_point      m_updated;
+        Clock::time_point      m_used; // last save served or cached
+        unsigned long          m_generation = 0; // generation of the feature when saved
+    };
+
+    struct Credentials
+    {
+        std::string                            m_passphrase;
+        std::string                            m_sessionToken;
+        std::map<dto::srr::FeatureName, Entry> m_features;
+    };
+
+    std::string          m_endpoint;
+    std::string          m_clientName;
+    std::string          m_stream;
+    std::chrono::seconds m_ttl;
+    SaveFunction         m_save;
+
+    std::mutex                         m_mutex;
+    std::condition_variable            m_cv;
+    bool                               m_stop = false;
+    std::map<std::string, Credentials> m_entries; // by hash of the passphrase and session token
+
+    // incremented on each change event of a feature, cached or not
+    std::map<dto::srr::FeatureName, unsigned long> m_generations;
+
+    zactor_t*   m_actor = nullptr;
+    std::thread m_refreshThread;
+
+    static std::string key(const std::string& passphrase, const std::string& sessionToken);
+
+    bool isStale(const dto::srr::FeatureName& featureName, const Entry& entry) const;
+
+    void refreshLoop();
+};
+
+} // namespace srr
@@ -0,0 +1,73 @@
+/*  =========================================================================
+    singleFlight - Coalescing of the identical concurrent agent saves
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/singleFlight.h"
+#include "helpers/data_integrity.h"
+#include "helpers/metrics.h"
+#include <fty_log.h>
+
+namespace srr {
+
+std::string SaveSingleFlight::key(
+    const dto::srr::FeatureName& featureName, const std::string& passphrase, const std::string& sessionToken)
+{
+    // do not keep the credentials in the key
+    return featureName + "/" + evalSha256(passphrase + "/" + sessionToken);
+}
+
+dto::srr::SaveResponse SaveSingleFlight::run(const std::string& key, const SaveFunction& save)
+{
+    std::promise<dto::srr::SaveResponse> promise;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        auto found = m_inFlight.find(key);
+        if (found != m_inFlight.end()) {
+            std::shared_future<dto::srr::SaveResponse> result = found->second;
+            lock.unlock();
+
+            Metrics::instance().saveCoalesced();
+
+            log_debug("Waiting for the save in flight of %s", key.substr(0, key.find('/')).c_str());
+            return result.get();
+        }
+        m_inFlight.emplace(key, promise.get_future().share());
+    }
+
+    try {
+        dto::srr::SaveResponse response = save();
+        promise.set_value(response);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inFlight.erase(key);
+
+        return response;
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inFlight.erase(key);
+
+        throw;
+    }
+}
+
+} // namespace srr
@@ -0,0 +1,61 @@
+/*  =========================================================================
+    singleFlight - Coalescing of the identical concurrent agent saves
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include <fty_common_dto.h>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace srr {
+
+/**
+ * Share the save of a feature between the concurrent save requests.
+ *
+ * The first request saving a feature with given credentials calls the agent,
+ * the requests arriving while it is in flight wait for its result (or its
+ * exception) instead of calling the agent again.
+ */
+class SaveSingleFlight
+{
+public:
+    using SaveFunction = std::function<dto::srr::SaveResponse()>;
+
+    // key of a feature save: the agent answer depends on the passphrase and the session token
+    static std::string key(
+        const dto::srr::FeatureName& featureName, const std::string& passphrase, const std::string& sessionToken);
+
+    /**
+     * Save a feature, or wait for the identical save in flight
+     * @param key Key of the save
+     * @param save Function calling the agent
+     */
+    dto::srr::SaveResponse run(const std::string& key, const SaveFunction& save);
+
+private:
+    std::mutex                                                         m_mutex;
+    std::map<std::string, std::shared_future<dto::srr::SaveResponse>> m_inFlight;
+};
+
+} // namespace srr
@@ -0,0 +1,339 @@
+/*  =========================================================================
+    snapshotStore - Content addressed store of the saves
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/snapshotStore.h"
+#include "fty_srr_exception.h"
+#include "helpers/data_integrity.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <fty_common_dto.h>
+#include <fty_log.h>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MANIFEST_EXTENSION ".json"
+
+namespace srr {
+
+static void makeDir(const std::string& path)
+{
+    if (mkdir(path.c_str(), 0700) != 0 && errno != EEXIST) {
+        throw SrrException("Cannot create directory " + path + ": " + strerror(errno));
+    }
+}
+
+static bool fileExists(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+// write into a temporary file then rename it, so that a file is either complete or missing
+static void writeFile(const std::string& path, const std::string& content)
+{
+    const std::string tmpPath = path + ".tmp";
+
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        throw SrrException("Cannot create file " + tmpPath + ": " + strerror(errno));
+    }
+
+    size_t written = 0;
+    while (written < content.size()) {
+        ssize_t ret = write(fd, content.data() + written, content.size() - written);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            const std::string error = strerror(errno);
+            close(fd);
+            unlink(tmpPath.c_str());
+            throw SrrException("Cannot write file " + tmpPath + ": " + error);
+        }
+        written += static_cast<size_t>(ret);
+    }
+    fsync(fd);
+    close(fd);
+
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        throw SrrException("Cannot rename file " + tmpPath + ": " + strerror(errno));
+    }
+}
+
+static std::string readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw SrrException("Cannot read file " + path);
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static std::vector<std::string> listDir(const std::string& path)
+{
+    std::vector<std::string> entries;
+
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return entries;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name != "." && name != "..") {
+            entries.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SnapshotStore::SnapshotStore(const std::string& rootDir, unsigned retention)
+    : m_rootDir(rootDir)
+    , m_retention(std::max(retention, 1u))
+{
+    makeDir(m_rootDir);
+    makeDir(m_rootDir + "/blobs");
+    makeDir(m_rootDir + "/manifests");
+}
+
+std::string SnapshotStore::blobPath(const std::string& hash) const
+{
+    return m_rootDir + "/blobs/" + hash.substr(0, 2) + "/" + hash;
+}
+
+std::string SnapshotStore::manifestPath(const std::string& snapshotId) const
+{
+    return m_rootDir + "/manifests/" + snapshotId + MANIFEST_EXTENSION;
+}
+
+SnapshotManifest SnapshotStore::store(const SrrSaveResponse& save)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    SnapshotManifest manifest;
+    manifest.m_version  = save.m_version;
+    manifest.m_checksum = save.m_checksum;
+
+    for (const auto& group : save.m_data) {
+        SnapshotGroup snapshotGroup;
+        snapshotGroup.m_group_id       = group.m_group_id;
+        snapshotGroup.m_group_name     = group.m_group_name;
+        snapshotGroup.m_data_integrity = group.m_data_integrity;
+
+        for (const auto& feature : group.m_features) {
+            const std::string& data = feature.m_feature_and_status.feature().data();
+
+            SnapshotFeature snapshotFeature;
+            snapshotFeature.m_name    = feature.m_feature_name;
+            snapshotFeature.m_version = feature.m_feature_and_status.feature().version();
+            snapshotFeature.m_status  = dto::srr::statusToString(feature.m_feature_and_status.status().status());
+            snapshotFeature.m_error   = feature.m_feature_and_status.status().error();
+            snapshotFeature.m_hash    = evalSha256(data);
+            snapshotFeature.m_size    = data.size();
+
+            // unchanged features are already in the store
+            const std::string path = blobPath(snapshotFeature.m_hash);
+            if (!fileExists(path)) {
+                makeDir(m_rootDir + "/blobs/" + snapshotFeature.m_hash.substr(0, 2));
+                writeFile(path, data);
+                manifest.m_written += data.size();
+            }
+            manifest.m_size += data.size();
+
+            snapshotGroup.m_features.push_back(snapshotFeature);
+        }
+        manifest.m_groups.push_back(snapshotGroup);
+    }
+
+    // ids are sorted by date, then by a sequence number for the snapshots stored within the same second
+    const std::time_t now = std::time(nullptr);
+    std::tm           tm;
+    char              date[32];
+    gmtime_r(&now, &tm);
+    std::strftime(date, sizeof(date), "%Y%m%dT%H%M%SZ", &tm);
+    manifest.m_date = date;
+
+    unsigned                       sequence = 0;
+    const std::vector<std::string> ids      = snapshotIdsLocked();
+    const std::string              prefix   = manifest.m_date + "-";
+    if (!ids.empty() && ids.back().compare(0, prefix.size(), prefix) == 0) {
+        sequence = static_cast<unsigned>(std::strtoul(ids.back().c_str() + prefix.size(), nullptr, 10)) + 1;
+    }
+    char sequenceStr[16];
+    std::snprintf(sequenceStr, sizeof(sequenceStr), "%04u", sequence);
+
+    cxxtools::SerializationInfo content;
+    content <<= manifest;
+    manifest.m_id =
+        prefix + sequenceStr + "-" + evalSha256(dto::srr::serializeJson(content, false)).substr(0, 8);
+
+    cxxtools::SerializationInfo si;
+    si <<= manifest;
+    writeFile(manifestPath(manifest.m_id), dto::srr::serializeJson(si, false));
+
+    log_info("Snapshot %s stored: %llu bytes, %llu bytes written", manifest.m_id.c_str(),
+        static_cast<unsigned long long>(manifest.m_size), static_cast<unsigned long long>(manifest.m_written));
+
+    applyRetentionLocked();
+
+    return manifest;
+}
+
+std::vector<std::string> SnapshotStore::snapshotIdsLocked() const
+{
+    std::vector<std::string> ids;
+
+    const std::string extension = MANIFEST_EXTENSION;
+    for (const auto& name : listDir(m_rootDir + "/manifests")) {
+        if (name.size() > extension.size() &&
+            name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+            ids.push_back(name.substr(0, name.size() - extension.size()));
+        }
+    }
+    return ids;
+}
+
+SnapshotManifest SnapshotStore::manifestLocked(const std::string& snapshotId) const
+{
+    // ids are used to build a path
+    if (snapshotId.empty() || snapshotId.find('/') != std::string::npos || snapshotId[0] == '.') {
+        throw SrrException("Invalid snapshot id " + snapshotId);
+    }
+    if (!fileExists(manifestPath(snapshotId))) {
+        throw SrrException("Snapshot " + snapshotId + " not found");
+    }
+
+    SnapshotManifest            manifest;
+    cxxtools::SerializationInfo si = dto::srr::deserializeJson(readFile(manifestPath(snapshotId)));
+    si >>= manifest;
+
+    return manifest;
+}
+
+std::vector<SnapshotManifest> SnapshotStore::list() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<SnapshotManifest> manifests;
+    for (const auto& id : snapshotIdsLocked()) {
+        try {
+            manifests.push_back(manifestLocked(id));
+        } catch (const std::exception& ex) {
+            log_error("Invalid snapshot %s: %s", id.c_str(), ex.what());
+        }
+    }
+    return manifests;
+}
+
+SnapshotManifest SnapshotStore::manifest(const std::string& snapshotId) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return manifestLocked(snapshotId);
+}
+
+std::vector<Group> SnapshotStore::load(const std::string& snapshotId) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const SnapshotManifest manifest = manifestLocked(snapshotId);
+
+    std::vector<Group> groups;
+    for (const auto& snapshotGroup : manifest.m_groups) {
+        Group group;
+        group.m_group_id       = snapshotGroup.m_group_id;
+        group.m_group_name     = snapshotGroup.m_group_name;
+        group.m_data_integrity = snapshotGroup.m_data_integrity;
+
+        for (const auto& snapshotFeature : snapshotGroup.m_features) {
+            std::string data = readFile(blobPath(snapshotFeature.m_hash));
+            if (evalSha256(data) != snapshotFeature.m_hash) {
+                throw SrrException("Blob " + snapshotFeature.m_hash + " of snapshot " + snapshotId + " is corrupted");
+            }
+
+            SrrFeature feature;
+            feature.m_feature_name = snapshotFeature.m_name;
+            feature.m_feature_and_status.mutable_status()->set_status(
+                dto::srr::stringToStatus(snapshotFeature.m_status));
+            feature.m_feature_and_status.mutable_status()->set_error(snapshotFeature.m_error);
+            feature.m_feature_and_status.mutable_feature()->set_version(snapshotFeature.m_version);
+            feature.m_feature_and_status.mutable_feature()->set_data(std::move(data));
+
+            group.m_features.push_back(feature);
+        }
+        groups.push_back(group);
+    }
+    return groups;
+}
+
+void SnapshotStore::applyRetentionLocked()
+{
+    std::vector<std::string> ids = snapshotIdsLocked();
+    if (ids.size() <= m_retention) {
+        return;
+    }
+
+    for (size_t i = 0; i < ids.size() - m_retention; i++) {
+        log_debug("Removing snapshot %s", ids[i].c_str());
+        unlink(manifestPath(ids[i]).c_str());
+    }
+
+    // remove the blobs which are not referenced by any remaining snapshot
+    std::set<std::string> referenced;
+    for (const auto& id : snapshotIdsLocked()) {
+        try {
+            for (const auto& group : manifestLocked(id).m_groups) {
+                for (const auto& feature : group.m_features) {
+                    referenced.insert(feature.m_hash);
+                }
+            }
+        } catch (const std::exception& ex) {
+            // do not risk to remove blobs of a snapshot which can't be read
+            log_error("Invalid snapshot %s, blobs will not be garbage collected: %s", id.c_str(), ex.what());
+            return;
+        }
+    }
+
+    for (const auto& prefix : listDir(m_rootDir + "/blobs")) {
+        for (const auto& hash : listDir(m_rootDir + "/blobs/" + prefix)) {
+            if (referenced.count(hash) == 0) {
+                unlink((m_rootDir + "/blobs/" + prefix + "/" + hash).c_str());
+            }
+        }
+    }
+}
+
+} // namespace srr
@@ -0,0 +1,77 @@
+/*  =========================================================================
+    snapshotStore - Content addressed store of the saves
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include "dto/response.h"
+#include "dto/snapshot.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace srr {
+
+/**
+ * Local store of the saves.
+ *
+ * The data of each feature is stored once in a blob named after its sha256
+ * (<root>/blobs/<2 first chars>/<hash>), and each save is described by a
+ * manifest (<root>/manifests/<id>.json) listing its groups and the blobs of
+ * their features. Only the most recent snapshots are kept, and the blobs
+ * which are not referenced anymore are removed.
+ */
+class SnapshotStore
+{
+public:
+    SnapshotStore(const std::string& rootDir, unsigned retention);
+
+    /**
+     * Store a save
+     * @param save Save response (groups with their integrity already evaluated)
+     * @return The manifest of the new snapshot
+     */
+    SnapshotManifest store(const SrrSaveResponse& save);
+
+    // manifests of the stored snapshots, oldest first
+    std::vector<SnapshotManifest> list() const;
+
+    SnapshotManifest manifest(const std::string& snapshotId) const;
+
+    /**
+     * Rebuild the groups of a stored snapshot
+     * @throw SrrException if the snapshot or one of its blobs is missing or corrupted
+     */
+    std::vector<Group> load(const std::string& snapshotId) const;
+
+private:
+    std::string        m_rootDir;
+    unsigned           m_retention;
+    mutable std::mutex m_mutex;
+
+    std::string blobPath(const std::string& hash) const;
+    std::string manifestPath(const std::string& snapshotId) const;
+
+    std::vector<std::string> snapshotIdsLocked() const;
+    SnapshotManifest         manifestLocked(const std::string& snapshotId) const;
+    void                     applyRetentionLocked();
+};
+
+} // namespace srr
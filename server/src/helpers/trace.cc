@@ -0,0 +1,255 @@
+/*  =========================================================================
+    trace - Scoped trace spans with Chrome trace export
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cxxtools/serializationinfo.h>
+#include <fty_common_dto.h>
+
+#define TRACE_BUFFER_SIZE     4096
+#define TRACE_RETAINED_EVENTS 100000
+
+namespace srr {
+
+/**
+ * Single producer / single consumer ring buffer. The owning thread is the
+ * only producer, the consumer is the exporter (serialized by Tracer::m_mutex).
+ */
+class Tracer::ThreadBuffer
+{
+public:
+    explicit ThreadBuffer(uint32_t threadId)
+        : m_threadId(threadId)
+        , m_events(TRACE_BUFFER_SIZE)
+    {
+    }
+
+    uint32_t threadId() const
+    {
+        return m_threadId;
+    }
+
+    bool push(TraceEvent&& event)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) % m_events.size();
+        if (next == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        m_events[tail] = std::move(event);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Consumer>
+    void drain(Consumer&& consumer)
+    {
+        size_t       head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        while (head != tail) {
+            consumer(std::move(m_events[head]));
+            head = (head + 1) % m_events.size();
+        }
+        m_head.store(head, std::memory_order_release);
+    }
+
+private:
+    uint32_t                m_threadId;
+    std::vector<TraceEvent> m_events;
+    std::atomic<size_t>     m_head{0};
+    std::atomic<size_t>     m_tail{0};
+};
+
+Tracer::Tracer() = default;
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Tracer::isEnabled() const
+{
+    return m_enabled.load(std::memory_order_relaxed);
+}
+
+int64_t Tracer::nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+unsigned long Tracer::droppedEvents() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+Tracer::ThreadBuffer& Tracer::localBuffer()
+{
+    // a thread is created for each request: its buffer is released when it exits, not on the next export
+    struct LocalBuffer
+    {
+        std::shared_ptr<ThreadBuffer> m_buffer;
+
+        ~LocalBuffer()
+        {
+            if (m_buffer) {
+                Tracer::instance().releaseBuffer(m_buffer);
+            }
+        }
+    };
+    thread_local LocalBuffer local;
+
+    if (!local.m_buffer) {
+        local.m_buffer = std::make_shared<ThreadBuffer>(m_nextThreadId++);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffers.push_back(local.m_buffer);
+    }
+    return *local.m_buffer;
+}
+
+void Tracer::releaseBuffer(const std::shared_ptr<ThreadBuffer>& buffer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    buffer->drain([&](TraceEvent&& event) {
+        m_retained.push_back(std::move(event));
+    });
+    m_buffers.erase(std::remove(m_buffers.begin(), m_buffers.end(), buffer), m_buffers.end());
+
+    trimLocked();
+}
+
+void Tracer::record(TraceEvent&& event)
+{
+    ThreadBuffer& buffer = localBuffer();
+    event.m_threadId     = buffer.threadId();
+    if (!buffer.push(std::move(event))) {
+        m_dropped++;
+    }
+}
+
+void Tracer::drainLocked()
+{
+    for (auto& buffer : m_buffers) {
+        buffer->drain([&](TraceEvent&& event) {
+            m_retained.push_back(std::move(event));
+        });
+    }
+    trimLocked();
+}
+
+void Tracer::trimLocked()
+{
+    while (m_retained.size() > TRACE_RETAINED_EVENTS) {
+        m_retained.pop_front();
+    }
+}
+
+std::vector<TraceEvent> Tracer::collect(int64_t sinceUs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    drainLocked();
+
+    std::vector<TraceEvent> events;
+    for (const auto& event : m_retained) {
+        if (event.m_startUs >= sinceUs) {
+            events.push_back(event);
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const TraceEvent& l, const TraceEvent& r) {
+        return l.m_startUs < r.m_startUs;
+    });
+
+    return events;
+}
+
+static void operator<<=(cxxtools::SerializationInfo& si, const TraceEvent& event)
+{
+    si.addMember("name") <<= event.m_name;
+    si.addMember("cat") <<= event.m_category;
+    si.addMember("ph") <<= std::string("X");
+    si.addMember("ts") <<= event.m_startUs;
+    si.addMember("dur") <<= event.m_durationUs;
+    si.addMember("pid") <<= 1;
+    si.addMember("tid") <<= event.m_threadId;
+
+    cxxtools::SerializationInfo& args = si.addMember("args");
+    args.setCategory(cxxtools::SerializationInfo::Category::Object);
+    for (const auto& arg : event.m_args) {
+        args.addMember(arg.first) <<= arg.second;
+    }
+}
+
+std::string Tracer::exportChromeTrace(int64_t sinceUs)
+{
+    const std::vector<TraceEvent> events = collect(sinceUs);
+
+    cxxtools::SerializationInfo si;
+    si.addMember("traceEvents") <<= events;
+    si.addMember("displayTimeUnit") <<= std::string("ms");
+
+    return dto::srr::serializeJson(si, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TraceSpan::TraceSpan(const char* category, const std::string& name)
+    : m_active(Tracer::instance().isEnabled())
+{
+    if (m_active) {
+        m_event.m_category = category;
+        m_event.m_name     = name;
+        m_event.m_startUs  = Tracer::nowUs();
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    end();
+}
+
+void TraceSpan::end()
+{
+    if (m_active) {
+        m_active             = false;
+        m_event.m_durationUs = Tracer::nowUs() - m_event.m_startUs;
+        Tracer::instance().record(std::move(m_event));
+    }
+}
+
+TraceSpan& TraceSpan::tag(const std::string& key, const std::string& value)
+{
+    if (m_active) {
+        m_event.m_args[key] = value;
+    }
+    return *this;
+}
+
+} // namespace srr
@@ -0,0 +1,123 @@
+/*  =========================================================================
+    trace - Scoped trace spans with Chrome trace export
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace srr {
+
+struct TraceEvent
+{
+    std::string                        m_name;
+    std::string                        m_category;
+    std::map<std::string, std::string> m_args;
+    uint32_t                           m_threadId   = 0;
+    int64_t                            m_startUs    = 0;
+    int64_t                            m_durationUs = 0;
+};
+
+/**
+ * Collector of the trace events.
+ *
+ * Each thread records its events into its own single producer ring buffer,
+ * so recording never takes a lock. Buffers are drained when the events are
+ * exported or when their thread exits, and the last drained events are
+ * retained for later exports.
+ */
+class Tracer
+{
+public:
+    static Tracer& instance();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    // store an event in the buffer of the calling thread (dropped if the buffer is full)
+    void record(TraceEvent&& event);
+
+    /**
+     * Get the events which started after a given time
+     * @param sinceUs Start time of the oldest event to return (see nowUs())
+     */
+    std::vector<TraceEvent> collect(int64_t sinceUs = 0);
+
+    /**
+     * Export the events which started after a given time as Chrome trace event Json
+     * (can be loaded in chrome://tracing or Perfetto)
+     */
+    std::string exportChromeTrace(int64_t sinceUs = 0);
+
+    // monotonic time used for the events, in microseconds
+    static int64_t nowUs();
+
+    unsigned long droppedEvents() const;
+
+private:
+    class ThreadBuffer;
+
+    Tracer();
+
+    std::atomic<bool>          m_enabled{false};
+    std::atomic<uint32_t>      m_nextThreadId{1};
+    std::atomic<unsigned long> m_dropped{0};
+
+    std::mutex                                 m_mutex; // protects the buffer list and the retained events
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    std::deque<TraceEvent>                     m_retained;
+
+    ThreadBuffer& localBuffer();
+    void          releaseBuffer(const std::shared_ptr<ThreadBuffer>& buffer);
+    void          drainLocked();
+    void          trimLocked();
+};
+
+/**
+ * Span covering the lifetime of the object, recorded on destruction.
+ * Does nothing when tracing is disabled.
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(const char* category, const std::string& name);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    TraceSpan& tag(const std::string& key, const std::string& value);
+
+    // record the span now instead of on destruction
+    void end();
+
+private:
+    bool       m_active;
+    TraceEvent m_event;
+};
+
+} // namespace srr
@@ -21,18 +21,21 @@
 #include "dto/common.h"
 #include "fty_srr_exception.h"
 #include "fty_srr_groups.h"
+#include "helpers/metrics.h"
+#include "helpers/trace.h"
 #include <fty_common.h>
 #include <fty_common_messagebus.h>
+#include <memory>
 #include <thread>
 #include <unistd.h>
 
 namespace srr {
 // restart method
-void restartBiosService(const unsigned restartDelay)
+void restartBiosService(const unsigned restartDelay, Clock& clock)
 {
     for (unsigned i = restartDelay; i > 0; i--) {
         log_info("Rebooting in %d seconds...", i);
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        clock.sleepFor(std::chrono::seconds(1));
     }
 
     log_info("Reboot");
@@ -62,13 +65,47 @@ std::map<std::string, std::set<dto::srr::FeatureName>> groupFeaturesByAgent(
     return map;
 }
 
+void mergeResponse(dto::srr::SaveResponse& into, dto::srr::SaveResponse&& from)
+{
+    auto& features = *into.mutable_map_features_data();
+    for (auto& entry : *from.mutable_map_features_data()) {
+        features[entry.first].Swap(&entry.second);
+    }
+    from.Clear();
+}
+
+void mergeResponse(dto::srr::RestoreResponse& into, dto::srr::RestoreResponse&& from)
+{
+    auto& statuses = *into.mutable_map_features_status();
+    for (auto& entry : *from.mutable_map_features_status()) {
+        statuses[entry.first].Swap(&entry.second);
+    }
+    from.Clear();
+}
+
+void moveFeature(dto::srr::Feature& into, dto::srr::Feature& from)
+{
+    into.set_version(from.version());
+    into.mutable_data()->swap(*from.mutable_data());
+    from.clear_data();
+}
+
+static uint64_t userDataSize(const dto::UserData& userData)
+{
+    uint64_t size = 0;
+    for (const auto& data : userData) {
+        size += data.size();
+    }
+    return size;
+}
+
 /**
  * Send a response on the message bus.
  * @param msg
  * @param payload
  * @param subject
  */
-messagebus::Message sendRequest(messagebus::MessageBus& msgbus, const dto::UserData& userData,
+messagebus::Message sendRequest(messagebus::MessageBus& msgbus, dto::UserData userData,
     const std::string& action, const std::string& from, const std::string& queueNameDest,
     const std::string& agentNameDest, int timeout)
 {
@@ -78,21 +115,37 @@ messagebus::Message sendRequest(messagebus::MessageBus& msgbus, const dto::UserD
     //     log_debug("data:\n%s\n", msg.c_str());
     // }
 
+    TraceSpan span("bus", "sendRequest");
+    span.tag("agent", agentNameDest).tag("queue", queueNameDest).tag("action", action);
+
+    const auto     start        = std::chrono::steady_clock::now();
+    const uint64_t requestBytes = userDataSize(userData);
+
     messagebus::Message resp;
     try {
         messagebus::Message req;
-        req.userData() = userData;
+        req.userData() = std::move(userData);
         req.metaData().emplace(messagebus::Message::SUBJECT, action);
         req.metaData().emplace(messagebus::Message::FROM, from);
         req.metaData().emplace(messagebus::Message::TO, agentNameDest);
         req.metaData().emplace(messagebus::Message::CORRELATION_ID, messagebus::generateUuid());
         resp = msgbus.request(queueNameDest, req, timeout);
     } catch (messagebus::MessageBusException& ex) {
+        if (std::chrono::steady_clock::now() - start >= std::chrono::seconds(timeout)) {
+            Metrics::instance().agentTimeout(queueNameDest);
+        } else {
+            Metrics::instance().agentError(queueNameDest);
+        }
         throw SrrException(ex.what());
     } catch (...) {
+        Metrics::instance().agentError(queueNameDest);
         throw SrrException("Unknown error on send response to the message bus");
     }
 
+    Metrics::instance().agentRequest(queueNameDest, action,
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start),
+        requestBytes, userDataSize(resp.userData()));
+
     log_debug("Message received from %s with action %s", resp.metaData().at(messagebus::Message::FROM).c_str(),
         resp.metaData().at(messagebus::Message::SUBJECT).c_str());
 
@@ -102,4 +155,168 @@ messagebus::Message sendRequest(messagebus::MessageBus& msgbus, const dto::UserD
     return resp;
 }
 
+PendingRequest::PendingRequest(messagebus::MessageBus& msgbus, const std::string& agentNameDest,
+    const std::string& queueNameDest, const std::string& action, const std::string& replyQueue,
+    std::shared_future<ReceivedMessage> response, std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::time_point deadline, uint64_t requestBytes)
+    : m_msgBus(&msgbus)
+    , m_agentNameDest(agentNameDest)
+    , m_queueNameDest(queueNameDest)
+    , m_action(action)
+    , m_replyQueue(replyQueue)
+    , m_response(response)
+    , m_start(start)
+    , m_deadline(deadline)
+    , m_requestBytes(requestBytes)
+    , m_listening(true)
+{
+}
+
+PendingRequest::PendingRequest(PendingRequest&& other)
+    : m_msgBus(other.m_msgBus)
+    , m_agentNameDest(std::move(other.m_agentNameDest))
+    , m_queueNameDest(std::move(other.m_queueNameDest))
+    , m_action(std::move(other.m_action))
+    , m_replyQueue(std::move(other.m_replyQueue))
+    , m_response(std::move(other.m_response))
+    , m_start(other.m_start)
+    , m_deadline(other.m_deadline)
+    , m_requestBytes(other.m_requestBytes)
+    , m_listening(other.m_listening)
+{
+    other.m_listening = false;
+}
+
+PendingRequest::~PendingRequest()
+{
+    release();
+}
+
+const std::string& PendingRequest::agentName() const
+{
+    return m_agentNameDest;
+}
+
+const std::string& PendingRequest::queueName() const
+{
+    return m_queueNameDest;
+}
+
+std::chrono::steady_clock::time_point PendingRequest::deadline() const
+{
+    return m_deadline;
+}
+
+bool PendingRequest::isReady() const
+{
+    return m_response.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+messagebus::Message PendingRequest::get()
+{
+    if (m_response.wait_until(m_deadline) != std::future_status::ready) {
+        release();
+        Metrics::instance().agentTimeout(m_queueNameDest);
+        throw SrrException("Request to agent " + m_agentNameDest + " timed out");
+    }
+    release();
+
+    messagebus::Message resp = m_response.get().m_message;
+    Metrics::instance().agentRequest(m_queueNameDest, m_action,
+        std::chrono::duration_cast<std::chrono::microseconds>(receivedAt() - m_start), m_requestBytes,
+        userDataSize(resp.userData()));
+
+    log_debug("Message received from %s with action %s", resp.metaData().at(messagebus::Message::FROM).c_str(),
+        resp.metaData().at(messagebus::Message::SUBJECT).c_str());
+
+    return resp;
+}
+
+std::chrono::steady_clock::time_point PendingRequest::receivedAt() const
+{
+    return m_response.get().m_received;
+}
+
+void PendingRequest::release()
+{
+    if (!m_listening) {
+        return;
+    }
+    m_listening = false;
+    try {
+        m_msgBus->unsubscribe(m_replyQueue);
+    } catch (...) {
+        log_warning("Failed to release reply queue %s", m_replyQueue.c_str());
+    }
+}
+
+/**
+ * Send a request on the message bus and return immediately.
+ * @param msgbus
+ * @param userData
+ * @param action
+ * @param from
+ * @param queueNameDest
+ * @param agentNameDest
+ * @param timeout in seconds
+ */
+PendingRequest sendRequestAsync(messagebus::MessageBus& msgbus, dto::UserData userData,
+    const std::string& action, const std::string& from, const std::string& queueNameDest,
+    const std::string& agentNameDest, int timeout)
+{
+    return sendRequestAsync(
+        msgbus, std::move(userData), action, from, queueNameDest, agentNameDest,
+        std::chrono::milliseconds(timeout * 1000));
+}
+
+PendingRequest sendRequestAsync(messagebus::MessageBus& msgbus, dto::UserData userData,
+    const std::string& action, const std::string& from, const std::string& queueNameDest,
+    const std::string& agentNameDest, std::chrono::milliseconds timeout)
+{
+    log_debug("Send async message from %s to %s:%s with action %s", from.c_str(), agentNameDest.c_str(),
+        queueNameDest.c_str(), action.c_str());
+
+    const std::string correlationId = messagebus::generateUuid();
+    const std::string replyQueue    = from + "." + correlationId;
+
+    // the listener may be called from the bus thread, the promise must only be set once
+    auto promise  = std::make_shared<std::promise<ReceivedMessage>>();
+    auto answered = std::make_shared<std::once_flag>();
+
+    std::shared_future<ReceivedMessage> response = promise->get_future().share();
+
+    const auto     start        = std::chrono::steady_clock::now();
+    const uint64_t requestBytes = userDataSize(userData);
+
+    try {
+        messagebus::Message req;
+        req.userData() = std::move(userData);
+        req.metaData().emplace(messagebus::Message::SUBJECT, action);
+        req.metaData().emplace(messagebus::Message::FROM, from);
+        req.metaData().emplace(messagebus::Message::TO, agentNameDest);
+        req.metaData().emplace(messagebus::Message::CORRELATION_ID, correlationId);
+        req.metaData().emplace(messagebus::Message::REPLY_TO, replyQueue);
+
+        msgbus.sendRequest(queueNameDest, req, [promise, answered, correlationId](messagebus::Message resp) {
+            auto found = resp.metaData().find(messagebus::Message::CORRELATION_ID);
+            if (found == resp.metaData().end() || found->second != correlationId) {
+                log_warning("Discarding response with unexpected correlation id");
+                return;
+            }
+            std::call_once(*answered, [&]() {
+                promise->set_value({resp, std::chrono::steady_clock::now()});
+            });
+        });
+    } catch (messagebus::MessageBusException& ex) {
+        Metrics::instance().agentError(queueNameDest);
+        throw SrrException(ex.what());
+    } catch (...) {
+        Metrics::instance().agentError(queueNameDest);
+        throw SrrException("Unknown error on send request to the message bus");
+    }
+
+    return PendingRequest(
+        msgbus, agentNameDest, queueNameDest, action, replyQueue, response, start, start + timeout, requestBytes);
+}
+
 } // namespace srr
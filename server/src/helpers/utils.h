@@ -21,23 +21,111 @@
 
 #pragma once
 
+#include "helpers/clock.h"
+#include <chrono>
 #include <fty_common_dto.h>
+#include <fty_common_messagebus.h>
+#include <future>
 #include <map>
 #include <string>
 
-namespace messagebus {
-class Message;
-class MessageBus;
-} // namespace messagebus
-
 namespace srr {
-void restartBiosService(const unsigned restartDelay);
+void restartBiosService(const unsigned restartDelay, Clock& clock = Clock::system());
 
 std::map<std::string, std::set<dto::srr::FeatureName>> groupFeaturesByAgent(
     const std::list<dto::srr::FeatureName>& features);
 
-messagebus::Message sendRequest(messagebus::MessageBus& msgbus, const dto::UserData& userData,
+/**
+ * Merge the features of a response into another one, the features being moved.
+ * Unlike the operator += of the DTO library, the feature data is not copied.
+ */
+void mergeResponse(dto::srr::SaveResponse& into, dto::srr::SaveResponse&& from);
+void mergeResponse(dto::srr::RestoreResponse& into, dto::srr::RestoreResponse&& from);
+
+/**
+ * Move the data of a feature into another one, the data being left empty.
+ * Unlike Swap(), the data is not copied when the messages are owned by different arenas.
+ */
+void moveFeature(dto::srr::Feature& into, dto::srr::Feature& from);
+
+// the frames are moved into the request message, pass an rvalue to avoid copying the payload
+messagebus::Message sendRequest(messagebus::MessageBus& msgbus, dto::UserData userData,
+    const std::string& action, const std::string& from, const std::string& queueNameDest,
+    const std::string& agentNameDest, int timeout = 60);
+
+// response of an agent, with the time it arrived at
+struct ReceivedMessage
+{
+    messagebus::Message                   m_message;
+    std::chrono::steady_clock::time_point m_received;
+};
+
+/**
+ * Request sent to an agent whose response has not been collected yet.
+ * The response is matched on a reply queue derived from the correlation id,
+ * so any number of requests can be in flight on the same message bus.
+ */
+class PendingRequest
+{
+public:
+    PendingRequest(messagebus::MessageBus& msgbus, const std::string& agentNameDest, const std::string& queueNameDest,
+        const std::string& action, const std::string& replyQueue, std::shared_future<ReceivedMessage> response,
+        std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point deadline,
+        uint64_t requestBytes);
+    PendingRequest(PendingRequest&& other);
+    PendingRequest& operator=(PendingRequest&& other) = delete;
+    PendingRequest(const PendingRequest&)            = delete;
+    PendingRequest& operator=(const PendingRequest&) = delete;
+    ~PendingRequest();
+
+    const std::string& agentName() const;
+    const std::string& queueName() const;
+
+    std::chrono::steady_clock::time_point deadline() const;
+
+    /**
+     * Check if the response arrived (non blocking)
+     */
+    bool isReady() const;
+
+    /**
+     * Wait for the response until the request deadline
+     * @return The response message
+     * @throw SrrException on timeout
+     */
+    messagebus::Message get();
+
+    /**
+     * Time the response arrived at, the responses being collected one after another
+     * @pre get() returned the response
+     */
+    std::chrono::steady_clock::time_point receivedAt() const;
+
+private:
+    messagebus::MessageBus*                 m_msgBus;
+    std::string                             m_agentNameDest;
+    std::string                             m_queueNameDest;
+    std::string                             m_action;
+    std::string                             m_replyQueue;
+    std::shared_future<ReceivedMessage>     m_response;
+    std::chrono::steady_clock::time_point   m_start;
+    std::chrono::steady_clock::time_point   m_deadline;
+    uint64_t                                m_requestBytes; // for the metrics
+    bool                                    m_listening;
+
+    void release();
+};
+
+/**
+ * Send a request without waiting for the response.
+ * The frames are moved into the request message, as for sendRequest.
+ * @return Handle used to collect the response before the deadline (now + timeout)
+ */
+PendingRequest sendRequestAsync(messagebus::MessageBus& msgbus, dto::UserData userData,
     const std::string& action, const std::string& from, const std::string& queueNameDest,
     const std::string& agentNameDest, int timeout = 60);
+PendingRequest sendRequestAsync(messagebus::MessageBus& msgbus, dto::UserData userData,
+    const std::string& action, const std::string& from, const std::string& queueNameDest,
+    const std::string& agentNameDest, std::chrono::milliseconds timeout);
 
 } // namespace srr
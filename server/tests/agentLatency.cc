@@ -0,0 +1,75 @@
+/*  =========================================================================
+    agentLatency - Tests of the adaptive agent timeouts
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/agentLatency.h"
+#include <catch2/catch.hpp>
+
+using namespace srr;
+
+TEST_CASE("Agent timeout is the cap until enough samples are known")
+{
+    AgentLatencyTracker latency;
+    latency.setCap(AgentOperation::SAVE, std::chrono::seconds(30));
+
+    CHECK(latency.timeout("queue", AgentOperation::SAVE) == std::chrono::seconds(30));
+    latency.record("queue", AgentOperation::SAVE, std::chrono::milliseconds(100));
+    CHECK(latency.timeout("queue", AgentOperation::SAVE) == std::chrono::seconds(30));
+}
+
+TEST_CASE("Agent save timeout adapts to the latencies, between floor and cap")
+{
+    AgentLatencyTracker latency;
+    latency.setCap(AgentOperation::SAVE, std::chrono::seconds(30));
+
+    for (int i = 0; i < 10; i++) {
+        latency.record("fast", AgentOperation::SAVE, std::chrono::milliseconds(100));
+        latency.record("slow", AgentOperation::SAVE, std::chrono::milliseconds(5000));
+        latency.record("stuck", AgentOperation::SAVE, std::chrono::milliseconds(20000));
+    }
+
+    CHECK(latency.timeout("fast", AgentOperation::SAVE) == std::chrono::seconds(10));
+    CHECK(latency.timeout("slow", AgentOperation::SAVE) == std::chrono::seconds(20));
+    CHECK(latency.timeout("stuck", AgentOperation::SAVE) == std::chrono::seconds(30));
+}
+
+TEST_CASE("Agent restore and reset timeouts are not shortened when their floor is the cap")
+{
+    AgentLatencyTracker latency;
+    for (auto op : {AgentOperation::RESTORE, AgentOperation::RESET}) {
+        latency.setCap(op, std::chrono::seconds(60));
+        latency.setFloor(op, std::chrono::seconds(60));
+        for (int i = 0; i < 10; i++) {
+            latency.record("queue", op, std::chrono::milliseconds(100));
+        }
+
+        CHECK(latency.timeout("queue", op) == std::chrono::seconds(60));
+        CHECK(latency.percentile("queue", op, 0.99) == std::chrono::milliseconds(100));
+    }
+}
+
+TEST_CASE("Agent timeout override replaces the adaptive value")
+{
+    AgentLatencyTracker latency;
+    latency.setCap(AgentOperation::SAVE, std::chrono::seconds(30));
+    latency.setOverride("queue", std::chrono::seconds(120));
+
+    CHECK(latency.timeout("queue", AgentOperation::SAVE) == std::chrono::seconds(120));
+}
@@ -0,0 +1,136 @@
+/*  =========================================================================
+    busPool - Tests of the pool of message bus clients
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/busPool.h"
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <malamute.h>
+#include <set>
+#include <thread>
+
+#define TEST_ENDPOINT    "ipc://@/fty-srr-test-bus-pool"
+#define TEST_CLIENT_NAME "fty-srr-test"
+
+using namespace srr;
+
+namespace {
+
+class Broker
+{
+public:
+    Broker()
+    {
+        m_broker = zactor_new(mlm_server, const_cast<char*>("Malamute"));
+        zstr_sendx(m_broker, "BIND", TEST_ENDPOINT, nullptr);
+    }
+
+    ~Broker()
+    {
+        zactor_destroy(&m_broker);
+    }
+
+private:
+    zactor_t* m_broker = nullptr;
+};
+
+} // namespace
+
+TEST_CASE("Bus pool clients")
+{
+    Broker broker;
+
+    SECTION("First client keeps the agent name")
+    {
+        MessageBusPool pool(TEST_ENDPOINT, TEST_CLIENT_NAME, 3);
+        CHECK(pool.stats().m_size == 3);
+
+        auto first  = pool.checkout();
+        auto second = pool.checkout();
+        auto third  = pool.checkout();
+        CHECK(first.clientName() == TEST_CLIENT_NAME);
+
+        std::set<std::string> names = {first.clientName(), second.clientName(), third.clientName()};
+        CHECK(names == std::set<std::string>{TEST_CLIENT_NAME, TEST_CLIENT_NAME "-1", TEST_CLIENT_NAME "-2"});
+    }
+
+    SECTION("Empty pool has one client")
+    {
+        MessageBusPool pool(TEST_ENDPOINT, TEST_CLIENT_NAME, 0);
+        CHECK(pool.stats().m_size == 1);
+        CHECK(pool.checkout().clientName() == TEST_CLIENT_NAME);
+    }
+}
+
+TEST_CASE("Bus pool statistics")
+{
+    Broker         broker;
+    MessageBusPool pool(TEST_ENDPOINT, TEST_CLIENT_NAME, 3);
+
+    {
+        auto first  = pool.checkout();
+        auto second = pool.checkout();
+        CHECK(pool.stats().m_inUse == 2);
+    }
+    CHECK(pool.stats().m_inUse == 0);
+
+    {
+        auto first = pool.checkout();
+        CHECK(pool.stats().m_inUse == 1);
+    }
+
+    auto stats = pool.stats();
+    CHECK(stats.m_inUse == 0);
+    CHECK(stats.m_peakInUse == 2);
+    CHECK(stats.m_checkouts == 3);
+    CHECK(stats.m_waits == 0);
+}
+
+TEST_CASE("Bus pool checkout waits for a free client")
+{
+    Broker         broker;
+    MessageBusPool pool(TEST_ENDPOINT, TEST_CLIENT_NAME, 1);
+
+    auto handle = std::make_unique<MessageBusPool::Handle>(pool.checkout());
+
+    std::atomic<bool> checkedOut{false};
+    std::string       name;
+    std::thread       waiter([&]() {
+        auto other = pool.checkout();
+        name       = other.clientName();
+        checkedOut = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    CHECK_FALSE(checkedOut);
+    CHECK(pool.stats().m_inUse == 1);
+
+    // giving the client back wakes the waiting checkout up
+    handle.reset();
+    waiter.join();
+    CHECK(checkedOut);
+    CHECK(name == TEST_CLIENT_NAME);
+
+    auto stats = pool.stats();
+    CHECK(stats.m_inUse == 0);
+    CHECK(stats.m_peakInUse == 1);
+    CHECK(stats.m_checkouts == 2);
+    CHECK(stats.m_waits == 1);
+}
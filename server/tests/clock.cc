@@ -0,0 +1,122 @@
+/*  =========================================================================
+    clock - Tests of the simulated clock
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/clock.h"
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <thread>
+
+using namespace srr;
+
+TEST_CASE("Simulated clock adds up the sleeps of a thread")
+{
+    SimulatedClock clock;
+    const auto     start = clock.now();
+
+    clock.sleepFor(std::chrono::seconds(6));
+    clock.sleepFor(std::chrono::seconds(6));
+
+    CHECK(clock.now() - start == std::chrono::seconds(12));
+    CHECK(clock.elapsed() == std::chrono::seconds(12));
+    CHECK(clock.sleepCount() == 2);
+}
+
+TEST_CASE("Simulated clock overlaps the sleeps of concurrent operations")
+{
+    SimulatedClock clock;
+
+    // both operations are started before any ends
+    std::atomic<int> started{0};
+    auto             begin = [&]() {
+        clock.beginOperation();
+        started++;
+        while (started < 2) {
+            std::this_thread::yield();
+        }
+    };
+
+    std::thread first([&]() {
+        begin();
+        clock.sleepFor(std::chrono::seconds(6));
+        clock.endOperation();
+    });
+    std::thread second([&]() {
+        begin();
+        clock.sleepFor(std::chrono::seconds(4));
+        clock.sleepFor(std::chrono::seconds(4));
+        clock.endOperation();
+    });
+    first.join();
+    second.join();
+
+    CHECK(clock.elapsed() == std::chrono::seconds(8));
+    CHECK(clock.sleepCount() == 3);
+}
+
+TEST_CASE("Simulated clock adds up the sleeps of sequential operations")
+{
+    SimulatedClock clock;
+
+    // each request of the UI runs on a new thread
+    for (int i = 1; i <= 3; i++) {
+        const auto  before = clock.elapsed();
+        std::thread thread([&]() {
+            clock.beginOperation();
+            clock.sleepFor(std::chrono::seconds(6));
+            clock.endOperation();
+        });
+        thread.join();
+
+        CHECK(clock.elapsed() - before == std::chrono::seconds(6));
+    }
+    CHECK(clock.elapsed() == std::chrono::seconds(18));
+
+    // an operation of a reused thread starts after the former one
+    clock.beginOperation();
+    clock.sleepFor(std::chrono::seconds(6));
+    clock.endOperation();
+    clock.beginOperation();
+    CHECK(clock.now().time_since_epoch() == std::chrono::seconds(24));
+    clock.endOperation();
+}
+
+TEST_CASE("Simulated clock advances all the operations")
+{
+    SimulatedClock clock;
+
+    clock.sleepFor(std::chrono::seconds(1));
+    clock.advance(std::chrono::seconds(2));
+    CHECK(clock.elapsed() == std::chrono::seconds(3));
+
+    // an operation starts at the advanced time
+    std::chrono::milliseconds operationTime{0};
+    std::thread               thread([&]() {
+        clock.beginOperation();
+        operationTime = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch());
+        clock.sleepFor(std::chrono::seconds(6));
+        clock.advance(std::chrono::seconds(1));
+        clock.endOperation();
+    });
+    thread.join();
+
+    CHECK(operationTime == std::chrono::seconds(3));
+    CHECK(clock.elapsed() == std::chrono::seconds(10));
+}
@@ -0,0 +1,96 @@
+/*  =========================================================================
+    dataIntegrity - Tests of the delta saves
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/data_integrity.h"
+#include "dto/common.h"
+#include "dto/snapshot.h"
+#include "fty-srr.h"
+#include "fty_srr_exception.h"
+#include <catch2/catch.hpp>
+#include <fty_common_dto.h>
+
+using namespace srr;
+
+namespace {
+
+SrrFeature buildFeature(const std::string& name, const std::string& data)
+{
+    SrrFeature feature;
+    feature.m_feature_name = name;
+    feature.m_feature_and_status.mutable_status()->set_status(dto::srr::Status::SUCCESS);
+    feature.m_feature_and_status.mutable_feature()->set_version("1.0");
+    feature.m_feature_and_status.mutable_feature()->set_data(data);
+    return feature;
+}
+
+std::vector<Group> buildSave(const SrrFeature& feature)
+{
+    Group group;
+    group.m_group_id = G_ASSETS;
+    group.m_features.push_back(feature);
+    return {group};
+}
+
+} // namespace
+
+TEST_CASE("Feature hash of a snapshot manifest matches the hash of the feature")
+{
+    const SrrFeature feature = buildFeature(F_ASSET_AGENT, "data");
+
+    SnapshotFeature snapshotFeature;
+    snapshotFeature.m_name    = feature.m_feature_name;
+    snapshotFeature.m_version = "1.0";
+    snapshotFeature.m_status  = dto::srr::statusToString(dto::srr::Status::SUCCESS);
+    snapshotFeature.m_hash    = evalSha256("data");
+
+    SnapshotGroup group;
+    group.m_features.push_back(snapshotFeature);
+    SnapshotManifest manifest;
+    manifest.m_groups.push_back(group);
+
+    CHECK(evalFeatureHashes(manifest) == evalFeatureHashes(buildSave(feature)));
+    CHECK(evalFeatureHash(feature) != evalFeatureHash(buildFeature(F_ASSET_AGENT, "other")));
+}
+
+TEST_CASE("Delta is resolved from its base")
+{
+    const SrrFeature base = buildFeature(F_ASSET_AGENT, "data");
+
+    SrrFeature ref = buildFeature(F_ASSET_AGENT, "");
+    ref.m_ref      = evalFeatureHash(base);
+
+    std::vector<Group> groups = buildSave(ref);
+    applyDelta(groups, buildSave(base));
+
+    CHECK(groups[0].m_features[0].m_ref.empty());
+    CHECK(groups[0].m_features[0].m_feature_and_status.feature().data() == "data");
+}
+
+TEST_CASE("Delta reports a missing base separately from a modified base")
+{
+    SrrFeature ref = buildFeature(F_ASSET_AGENT, "");
+    ref.m_ref      = evalFeatureHash(buildFeature(F_ASSET_AGENT, "data"));
+
+    std::vector<Group> groups = buildSave(ref);
+    CHECK_THROWS_WITH(applyDelta(groups, {}), Catch::Contains("not found"));
+    CHECK_THROWS_WITH(applyDelta(groups, buildSave(buildFeature(F_ASSET_AGENT, "modified"))),
+        Catch::Contains("does not match its reference"));
+}
@@ -0,0 +1,50 @@
+/*  =========================================================================
+    groups - Tests of the srr groups and features
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "fty_srr_groups.h"
+#include <algorithm>
+#include <catch2/catch.hpp>
+
+using namespace srr;
+
+TEST_CASE("Features of a group are reset in reverse priority order")
+{
+    for (const auto& group : g_srrGroupMap) {
+        const std::vector<std::string> features = getResetFeatures(group.first);
+
+        REQUIRE(features.size() == group.second.m_fp.size());
+        for (size_t i = 1; i < features.size(); i++) {
+            CHECK(getPriority(features[i - 1]) >= getPriority(features[i]));
+        }
+    }
+}
+
+TEST_CASE("Features of a group with several priorities are reset from the last restored one")
+{
+    const auto& featureList = g_srrGroupMap.at(G_ASSETS).m_fp;
+    REQUIRE(featureList.size() > 1);
+
+    unsigned lastPriority = 0;
+    for (const auto& fp : featureList) {
+        lastPriority = std::max(lastPriority, fp.m_priority);
+    }
+    CHECK(getPriority(getResetFeatures(G_ASSETS).front()) == lastPriority);
+}
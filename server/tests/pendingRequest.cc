@@ -0,0 +1,185 @@
+/*  =========================================================================
+    pendingRequest - Tests of the asynchronous agent requests
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "fty_srr_exception.h"
+#include "helpers/utils.h"
+#include <catch2/catch.hpp>
+#include <fty_common_messagebus.h>
+#include <malamute.h>
+#include <memory>
+#include <thread>
+
+#define TEST_ENDPOINT    "ipc://@/fty-srr-test-pending-request"
+#define TEST_CLIENT_NAME "fty-srr-test"
+#define TEST_AGENT_NAME  "fty-srr-test-agent"
+#define TEST_QUEUE       "ETN.Q.TEST.SRR"
+
+using namespace srr;
+
+namespace {
+
+enum class Answer
+{
+    ECHO,
+    WRONG_CORRELATION_ID,
+    NONE
+};
+
+// agent answering the requests of its queue with their own frames, after a delay
+class Responder
+{
+public:
+    Responder(std::chrono::milliseconds delay, Answer answer)
+        : m_delay(delay)
+        , m_answer(answer)
+    {
+        m_bus = std::unique_ptr<messagebus::MessageBus>(messagebus::MlmMessageBus(TEST_ENDPOINT, TEST_AGENT_NAME));
+        m_bus->connect();
+        m_bus->receive(TEST_QUEUE, [this](messagebus::Message msg) {
+            handleRequest(msg);
+        });
+    }
+
+private:
+    std::chrono::milliseconds               m_delay;
+    Answer                                  m_answer;
+    std::unique_ptr<messagebus::MessageBus> m_bus;
+
+    void handleRequest(messagebus::Message msg)
+    {
+        if (m_answer == Answer::NONE) {
+            return;
+        }
+        std::this_thread::sleep_for(m_delay);
+
+        messagebus::Message reply;
+        reply.userData() = msg.userData();
+        reply.metaData().emplace(messagebus::Message::SUBJECT, msg.metaData().at(messagebus::Message::SUBJECT));
+        reply.metaData().emplace(messagebus::Message::FROM, TEST_AGENT_NAME);
+        reply.metaData().emplace(messagebus::Message::TO, msg.metaData().at(messagebus::Message::FROM));
+        reply.metaData().emplace(messagebus::Message::CORRELATION_ID,
+            m_answer == Answer::ECHO ? msg.metaData().at(messagebus::Message::CORRELATION_ID)
+                                     : messagebus::generateUuid());
+
+        m_bus->sendReply(msg.metaData().at(messagebus::Message::REPLY_TO), reply);
+    }
+};
+
+class BusFixture
+{
+public:
+    BusFixture()
+    {
+        m_broker = zactor_new(mlm_server, const_cast<char*>("Malamute"));
+        zstr_sendx(m_broker, "BIND", TEST_ENDPOINT, nullptr);
+
+        m_bus = std::unique_ptr<messagebus::MessageBus>(messagebus::MlmMessageBus(TEST_ENDPOINT, TEST_CLIENT_NAME));
+        m_bus->connect();
+    }
+
+    ~BusFixture()
+    {
+        m_bus.reset();
+        zactor_destroy(&m_broker);
+    }
+
+    PendingRequest send(const std::string& payload, std::chrono::milliseconds timeout)
+    {
+        return sendRequestAsync(*m_bus, {payload}, "test", TEST_CLIENT_NAME, TEST_QUEUE, TEST_AGENT_NAME, timeout);
+    }
+
+private:
+    zactor_t*                               m_broker = nullptr;
+    std::unique_ptr<messagebus::MessageBus> m_bus;
+};
+
+} // namespace
+
+TEST_CASE("Asynchronous request gets its response")
+{
+    BusFixture bus;
+    Responder  agent(std::chrono::milliseconds(100), Answer::ECHO);
+
+    const auto     start   = std::chrono::steady_clock::now();
+    PendingRequest request = bus.send("payload", std::chrono::seconds(5));
+    CHECK(request.agentName() == TEST_AGENT_NAME);
+    CHECK(request.queueName() == TEST_QUEUE);
+
+    // collected well after its arrival, as when the responses of other agents are collected first
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    CHECK(request.isReady());
+
+    messagebus::Message response = request.get();
+    REQUIRE(response.userData().size() == 1);
+    CHECK(response.userData().front() == "payload");
+
+    // the arrival time is the one of the response, not of its collection
+    CHECK(request.receivedAt() - start >= std::chrono::milliseconds(100));
+    CHECK(request.receivedAt() - start < std::chrono::milliseconds(900));
+}
+
+TEST_CASE("Asynchronous request times out at its deadline")
+{
+    BusFixture bus;
+    Responder  agent(std::chrono::milliseconds(0), Answer::NONE);
+
+    const auto     start   = std::chrono::steady_clock::now();
+    PendingRequest request = bus.send("payload", std::chrono::milliseconds(300));
+    CHECK(request.deadline() - start >= std::chrono::milliseconds(300));
+    CHECK_FALSE(request.isReady());
+
+    CHECK_THROWS_AS(request.get(), SrrException);
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(300));
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+}
+
+TEST_CASE("Asynchronous request discards a response to another request")
+{
+    BusFixture bus;
+    Responder  agent(std::chrono::milliseconds(0), Answer::WRONG_CORRELATION_ID);
+
+    PendingRequest request = bus.send("payload", std::chrono::milliseconds(500));
+    CHECK_THROWS_AS(request.get(), SrrException);
+}
+
+TEST_CASE("Asynchronous request releases its reply queue")
+{
+    BusFixture bus;
+
+    // the late response of the first request must not be taken by the second one
+    {
+        Responder      agent(std::chrono::milliseconds(500), Answer::ECHO);
+        PendingRequest first = bus.send("first", std::chrono::milliseconds(100));
+        CHECK_THROWS_AS(first.get(), SrrException);
+
+        PendingRequest second = bus.send("second", std::chrono::seconds(5));
+        messagebus::Message response = second.get();
+        REQUIRE(response.userData().size() == 1);
+        CHECK(response.userData().front() == "second");
+    }
+
+    // the requests on the same client keep working once their reply queues are released
+    Responder agent(std::chrono::milliseconds(0), Answer::ECHO);
+    for (int i = 0; i < 10; i++) {
+        PendingRequest request = bus.send(std::to_string(i), std::chrono::seconds(5));
+        CHECK(request.get().userData().front() == std::to_string(i));
+    }
+}
@@ -0,0 +1,175 @@
+/*  =========================================================================
+    request - Tests of the encoding of the srr requests
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "dto/request.h"
+#include "fty-srr.h"
+#include "legacy_request.h"
+#include <catch2/catch.hpp>
+#include <cxxtools/serializationinfo.h>
+#include <fty_common_dto.h>
+#include <pack/serialization.h>
+
+using namespace srr;
+using namespace srr::bench;
+
+namespace {
+
+// the requests are decoded by the former cxxtools code in older versions: all the members must be there
+cxxtools::SerializationInfo encode(const pack::Node& req)
+{
+    auto json = pack::json::serialize(req, pack::Option::WithDefaults);
+    REQUIRE(json);
+    return dto::srr::deserializeJson(*json);
+}
+
+std::string stringMember(const cxxtools::SerializationInfo& si, const std::string& name)
+{
+    std::string value;
+    si.getMember(name) >>= value;
+    return value;
+}
+
+std::vector<std::string> listMember(const cxxtools::SerializationInfo& si, const std::string& name)
+{
+    std::vector<std::string> value;
+    si.getMember(name) >>= value;
+    return value;
+}
+
+// the pack encoding decoded by the former decoder, re-encoded by the former encoder
+std::string legacyRoundTrip(const SrrSaveRequest& req)
+{
+    auto json = pack::json::serialize(req, pack::Option::WithDefaults);
+    REQUIRE(json);
+
+    SrrSaveRequest decoded;
+    legacyParseSaveRequest(*json, decoded);
+    return legacySaveRequestJson(decoded);
+}
+
+SrrSaveRequest fullSaveRequest()
+{
+    SrrSaveRequest req;
+    req.m_passphrase.setValue("passphrase");
+    req.m_group_list.setValue({G_ASSETS, G_NETWORK});
+    req.m_sessionToken.setValue("token");
+    req.m_base_snapshot_id.setValue("20200101T000000Z-0000-0000000000000001");
+    req.m_base_features.setValue({{F_ASSET_AGENT, "hash"}, {F_NETWORK, "other-hash"}});
+    return req;
+}
+
+} // namespace
+
+TEST_CASE("Save request has the bytes of the former encoding")
+{
+    const SrrSaveRequest req = fullSaveRequest();
+
+    // the encoders only differ on spacing: both are normalized by cxxtools
+    auto json = pack::json::serialize(req, pack::Option::WithDefaults);
+    REQUIRE(json);
+    CHECK(dto::srr::serializeJson(dto::srr::deserializeJson(*json), false) == legacySaveRequestJson(req));
+}
+
+TEST_CASE("Save request is decoded identically by the former decoder")
+{
+    CHECK(legacyRoundTrip(fullSaveRequest()) == legacySaveRequestJson(fullSaveRequest()));
+
+    // the former decoder requires the empty members
+    CHECK(legacyRoundTrip(SrrSaveRequest()) == legacySaveRequestJson(SrrSaveRequest()));
+}
+
+TEST_CASE("Former save request encoding is decoded identically")
+{
+    for (const auto& req : {fullSaveRequest(), SrrSaveRequest()}) {
+        SrrSaveRequest decoded;
+        REQUIRE(pack::json::deserialize(legacySaveRequestJson(req), decoded));
+        CHECK(legacySaveRequestJson(decoded) == legacySaveRequestJson(req));
+    }
+}
+
+TEST_CASE("Empty save request keeps all its members on the wire")
+{
+    const cxxtools::SerializationInfo si = encode(SrrSaveRequest());
+
+    CHECK(stringMember(si, SI_PASSPHRASE).empty());
+    CHECK(listMember(si, SI_GROUP_LIST).empty());
+    CHECK(stringMember(si, dto::srr::SESSION_TOKEN).empty());
+}
+
+TEST_CASE("Empty reset request keeps all its members on the wire")
+{
+    const cxxtools::SerializationInfo si = encode(SrrResetRequest());
+
+    CHECK(stringMember(si, SI_PASSPHRASE).empty());
+    CHECK(listMember(si, SI_GROUP_LIST).empty());
+    CHECK(stringMember(si, dto::srr::SESSION_TOKEN).empty());
+}
+
+TEST_CASE("Save request round trip")
+{
+    SrrSaveRequest req;
+    req.m_passphrase.setValue("passphrase");
+    req.m_group_list.setValue({G_ASSETS, G_NETWORK});
+    req.m_sessionToken.setValue("token");
+    req.m_base_snapshot_id.setValue("20200101T000000Z-0000000000000001");
+    req.m_base_features.setValue({{F_ASSET_AGENT, "hash"}});
+
+    auto json = pack::json::serialize(req, pack::Option::WithDefaults);
+    REQUIRE(json);
+
+    SrrSaveRequest decoded;
+    REQUIRE(pack::json::deserialize(*json, decoded));
+    CHECK(decoded.m_passphrase.value() == "passphrase");
+    CHECK(decoded.m_group_list.value() == std::vector<std::string>{G_ASSETS, G_NETWORK});
+    CHECK(decoded.m_sessionToken.value() == "token");
+    CHECK(decoded.m_base_snapshot_id.value() == "20200101T000000Z-0000000000000001");
+    CHECK(decoded.m_base_features.value() == std::map<std::string, std::string>{{F_ASSET_AGENT, "hash"}});
+}
+
+TEST_CASE("Save request without delta members is a full save")
+{
+    const std::string json = std::string("{\"") + SI_PASSPHRASE + "\":\"passphrase\",\"" + SI_GROUP_LIST +
+                             "\":[],\"" + dto::srr::SESSION_TOKEN + "\":\"\"}";
+
+    SrrSaveRequest decoded;
+    REQUIRE(pack::json::deserialize(json, decoded));
+    CHECK(decoded.m_passphrase.value() == "passphrase");
+    CHECK(decoded.m_group_list.value().empty());
+    CHECK(decoded.m_base_snapshot_id.value().empty());
+    CHECK(decoded.m_base_features.value().empty());
+}
+
+TEST_CASE("Reset request round trip")
+{
+    SrrResetRequest req;
+    req.m_passphrase.setValue("passphrase");
+    req.m_group_list.setValue({G_MONITORING});
+    req.m_sessionToken.setValue("token");
+
+    auto json = pack::json::serialize(req, pack::Option::WithDefaults);
+    REQUIRE(json);
+
+    SrrResetRequest decoded;
+    REQUIRE(pack::json::deserialize(*json, decoded));
+    CHECK(decoded.m_passphrase.value() == "passphrase");
+    CHECK(decoded.m_group_list.value() == std::vector<std::string>{G_MONITORING});
+    CHECK(decoded.m_sessionToken.value() == "token");
+}
@@ -0,0 +1,151 @@
+/*  =========================================================================
+    restorePlan - Tests of the restore plan
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "fty_srr_groups.h"
+#include "helpers/restorePlan.h"
+#include <algorithm>
+#include <catch2/catch.hpp>
+
+using namespace srr;
+
+namespace {
+
+PlanStep step(const std::string& agent, const std::string& feature)
+{
+    PlanStep planStep;
+    planStep.m_agent = agent;
+    planStep.m_features.push_back(feature);
+    return planStep;
+}
+
+GroupPlan groupPlan(const std::string& groupId, const std::string& agent, const std::string& feature)
+{
+    GroupPlan plan;
+    plan.m_group_id = groupId;
+    plan.m_backup.push_back(step(agent, feature));
+    plan.m_reset.push_back(step(agent, feature));
+    plan.m_restore.push_back(step(agent, feature));
+    return plan;
+}
+
+Group payloadGroup(const std::string& groupId)
+{
+    Group group;
+    group.m_group_id = groupId;
+    for (const auto& fp : g_srrGroupMap.at(groupId).m_fp) {
+        SrrFeature feature;
+        feature.m_feature_name = fp.m_feature;
+        group.m_features.push_back(feature);
+    }
+    return group;
+}
+
+} // namespace
+
+TEST_CASE("Restore steps batch the consecutive features of a same priority and a same agent")
+{
+    // discovery and monitoring are both restored first by the config agent
+    const std::vector<PlanStep> steps =
+        compileRestoreSteps({F_AUTOMATION_SETTINGS, F_MONITORING_FEATURE_NAME, F_DISCOVERY, F_SECURITY_WALLET});
+
+    REQUIRE(steps.size() == 3);
+    CHECK(steps[0].m_agent == CONFIG_AGENT_NAME);
+    CHECK(steps[0].m_features == std::vector<std::string>{F_MONITORING_FEATURE_NAME, F_DISCOVERY});
+    CHECK(steps[1].m_agent == SECU_WALLET_AGENT_NAME);
+    CHECK(steps[1].m_features == std::vector<std::string>{F_SECURITY_WALLET});
+    CHECK(steps[2].m_agent == CONFIG_AGENT_NAME);
+    CHECK(steps[2].m_features == std::vector<std::string>{F_AUTOMATION_SETTINGS});
+}
+
+TEST_CASE("Restore plan restores the features of a group in priority order")
+{
+    std::vector<Group> groups = {payloadGroup(G_MONITORING), payloadGroup(G_ASSETS)};
+    std::reverse(groups[1].m_features.begin(), groups[1].m_features.end());
+
+    const RestorePlan plan = compileRestorePlan(groups, "2.1", {});
+
+    REQUIRE(plan.m_groups.size() == 2);
+    CHECK(plan.m_groups[0].m_group_id == G_ASSETS);
+    CHECK(plan.m_groups[1].m_group_id == G_MONITORING);
+
+    const auto& featureList = g_srrGroupMap.at(G_ASSETS).m_fp;
+    const auto& restore     = plan.m_groups[0].m_restore;
+    REQUIRE(restore.size() == featureList.size());
+    for (size_t i = 0; i < restore.size(); i++) {
+        CHECK(restore[i].m_features == std::vector<std::string>{featureList[i].m_feature});
+    }
+}
+
+TEST_CASE("Restore plan skips the groups of unresponsive agents")
+{
+    const RestorePlan plan =
+        compileRestorePlan({payloadGroup(G_ASSETS), payloadGroup(G_MONITORING)}, "2.1", {ALERT_AGENT_NAME});
+
+    REQUIRE(plan.m_groups.size() == 2);
+    CHECK(!plan.m_groups[0].m_error.empty());
+    CHECK(plan.m_groups[1].m_error.empty());
+}
+
+TEST_CASE("Restore selection restricts the plan to the selected features")
+{
+    const RestorePlan plan = compileRestorePlan({payloadGroup(G_ASSETS), payloadGroup(G_MONITORING)}, "2.1", {},
+        RestoreSelection({G_ASSETS}, {F_ALERT_AGENT}));
+
+    REQUIRE(plan.m_groups.size() == 1);
+    for (const auto& step : plan.m_groups[0].m_restore) {
+        CHECK(step.m_features != std::vector<std::string>{F_ALERT_AGENT});
+    }
+    CHECK_THROWS(RestoreSelection({"unknown"}, {}));
+}
+
+TEST_CASE("Backup of a group overlaps the restore of the previous one only without shared agents")
+{
+    const GroupPlan assets    = groupPlan(G_ASSETS, ASSET_AGENT_NAME, F_ASSET_AGENT);
+    const GroupPlan alerts    = groupPlan(G_MONITORING, ALERT_AGENT_NAME, F_ALERT_AGENT);
+    const GroupPlan assetsToo = groupPlan(G_DISCOVERY, ASSET_AGENT_NAME, F_VIRTUAL_ASSETS);
+
+    CHECK(canOverlapBackup(assets, alerts));
+    CHECK(!canOverlapBackup(assets, assetsToo));
+
+    GroupPlan skipped;
+    skipped.m_group_id = G_RSYSLOG;
+    skipped.m_error    = "not supported";
+    CHECK(canOverlapBackup(skipped, assetsToo));
+}
+
+TEST_CASE("Restore plan estimate serializes the backups sharing agents with the previous group")
+{
+    AgentLatencyTracker latency;
+
+    RestorePlan overlapped;
+    overlapped.m_groups.push_back(groupPlan(G_ASSETS, ASSET_AGENT_NAME, F_ASSET_AGENT));
+    overlapped.m_groups.push_back(groupPlan(G_MONITORING, ALERT_AGENT_NAME, F_ALERT_AGENT));
+    estimateRestorePlan(overlapped, latency, std::chrono::milliseconds(0));
+
+    RestorePlan sequential;
+    sequential.m_groups.push_back(groupPlan(G_ASSETS, ASSET_AGENT_NAME, F_ASSET_AGENT));
+    sequential.m_groups.push_back(groupPlan(G_DISCOVERY, ASSET_AGENT_NAME, F_VIRTUAL_ASSETS));
+    estimateRestorePlan(sequential, latency, std::chrono::milliseconds(0));
+
+    // one backup, reset and restore step of 1 s each per group, without recorded latency
+    CHECK(overlapped.m_estimated_ms == 5000);
+    CHECK(sequential.m_estimated_ms == 6000);
+}
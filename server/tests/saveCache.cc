@@ -0,0 +1,98 @@
+/*  =========================================================================
+    saveCache - Tests of the cache of the saved features
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "fty-srr.h"
+#include "helpers/saveCache.h"
+#include <catch2/catch.hpp>
+#include <stdexcept>
+
+using namespace srr;
+
+namespace {
+
+// background saves fail, a refreshed feature is then dropped: a stale feature is never served
+dto::srr::SaveResponse failingSave(const dto::srr::FeatureName&, const std::string&, const std::string&)
+{
+    throw std::runtime_error("agent not reachable");
+}
+
+dto::srr::SaveResponse savedFeature(const std::string& data)
+{
+    dto::srr::SaveResponse save;
+    (*save.mutable_map_features_data())[F_ALERT_AGENT].mutable_feature()->set_data(data);
+    return save;
+}
+
+} // namespace
+
+TEST_CASE("Save cache serves the features per passphrase and session token")
+{
+    SaveCache cache("", "test", "", std::chrono::seconds(3600), failingSave);
+
+    cache.put(F_ALERT_AGENT, "passphrase", "token", savedFeature("alerts"), cache.generation(F_ALERT_AGENT));
+
+    dto::srr::SaveResponse save;
+    CHECK(cache.get(F_ALERT_AGENT, "passphrase", "token", save));
+    CHECK(save.map_features_data().at(F_ALERT_AGENT).feature().data() == "alerts");
+
+    CHECK(!cache.get(F_ALERT_AGENT, "passphrase", "other token", save));
+    CHECK(!cache.get(F_ALERT_AGENT, "other passphrase", "token", save));
+    CHECK(!cache.get(F_ASSET_AGENT, "passphrase", "token", save));
+}
+
+TEST_CASE("Save cache drops the features changed while being saved")
+{
+    SaveCache cache("", "test", "", std::chrono::seconds(3600), failingSave);
+
+    const unsigned long generation = cache.generation(F_ALERT_AGENT);
+    cache.invalidate(F_ALERT_AGENT);
+    cache.put(F_ALERT_AGENT, "passphrase", "token", savedFeature("alerts"), generation);
+
+    dto::srr::SaveResponse save;
+    CHECK(!cache.get(F_ALERT_AGENT, "passphrase", "token", save));
+
+    cache.put(F_ALERT_AGENT, "passphrase", "token", savedFeature("alerts"), cache.generation(F_ALERT_AGENT));
+    CHECK(cache.get(F_ALERT_AGENT, "passphrase", "token", save));
+}
+
+TEST_CASE("Save cache invalidates the features of a changed agent")
+{
+    SaveCache cache("", "test", "", std::chrono::seconds(3600), failingSave);
+
+    cache.put(F_ALERT_AGENT, "passphrase", "token", savedFeature("alerts"), cache.generation(F_ALERT_AGENT));
+    cache.put(F_ASSET_AGENT, "passphrase", "token", savedFeature("assets"), cache.generation(F_ASSET_AGENT));
+
+    cache.invalidate(ALERT_AGENT_NAME);
+
+    dto::srr::SaveResponse save;
+    CHECK(!cache.get(F_ALERT_AGENT, "passphrase", "token", save));
+    CHECK(cache.get(F_ASSET_AGENT, "passphrase", "token", save));
+}
+
+TEST_CASE("Save cache expires the features after the TTL")
+{
+    SaveCache cache("", "test", "", std::chrono::seconds(0), failingSave);
+
+    cache.put(F_ALERT_AGENT, "passphrase", "token", savedFeature("alerts"), cache.generation(F_ALERT_AGENT));
+
+    dto::srr::SaveResponse save;
+    CHECK(!cache.get(F_ALERT_AGENT, "passphrase", "token", save));
+}
@@ -0,0 +1,118 @@
+/*  =========================================================================
+    singleFlight - Tests of the shared feature saves
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "fty-srr.h"
+#include "helpers/singleFlight.h"
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace srr;
+
+namespace {
+
+// agent call held until released, counting the calls
+class HeldSave
+{
+public:
+    dto::srr::SaveResponse operator()()
+    {
+        m_calls++;
+        std::shared_future<void> released = m_released;
+        released.wait();
+        if (m_fail) {
+            throw std::runtime_error("agent failed");
+        }
+        dto::srr::SaveResponse save;
+        (*save.mutable_map_features_data())[F_ALERT_AGENT].mutable_feature()->set_data("alerts");
+        return save;
+    }
+
+    void release()
+    {
+        m_release.set_value();
+    }
+
+    std::atomic<int> m_calls{0};
+    bool             m_fail = false;
+
+private:
+    std::promise<void>       m_release;
+    std::shared_future<void> m_released = m_release.get_future().share();
+};
+
+} // namespace
+
+TEST_CASE("Concurrent identical saves share one agent call")
+{
+    SaveSingleFlight flights;
+    HeldSave         save;
+
+    const std::string key = SaveSingleFlight::key(F_ALERT_AGENT, "passphrase", "token");
+
+    std::vector<std::string> results(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < results.size(); i++) {
+        threads.emplace_back([&, i]() {
+            results[i] = flights.run(key, std::ref(save)).map_features_data().at(F_ALERT_AGENT).feature().data();
+        });
+    }
+    // let the saves join the first one before it completes
+    while (save.m_calls == 0) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    save.release();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(save.m_calls == 1);
+    for (const auto& result : results) {
+        CHECK(result == "alerts");
+    }
+}
+
+TEST_CASE("Saves with other credentials do not share the agent call")
+{
+    CHECK(SaveSingleFlight::key(F_ALERT_AGENT, "passphrase", "token") !=
+          SaveSingleFlight::key(F_ALERT_AGENT, "passphrase", "other token"));
+    CHECK(SaveSingleFlight::key(F_ALERT_AGENT, "passphrase", "token") !=
+          SaveSingleFlight::key(F_ALERT_AGENT, "other passphrase", "token"));
+    CHECK(SaveSingleFlight::key(F_ALERT_AGENT, "passphrase", "token") !=
+          SaveSingleFlight::key(F_ASSET_AGENT, "passphrase", "token"));
+}
+
+TEST_CASE("Failure of a shared save is reported to all the waiting saves, the next save calls the agent again")
+{
+    SaveSingleFlight flights;
+    HeldSave         failing;
+    failing.m_fail = true;
+    failing.release();
+
+    const std::string key = SaveSingleFlight::key(F_ALERT_AGENT, "passphrase", "token");
+    CHECK_THROWS(flights.run(key, std::ref(failing)));
+    CHECK_THROWS(flights.run(key, std::ref(failing)));
+    CHECK(failing.m_calls == 2);
+}
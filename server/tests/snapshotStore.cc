@@ -0,0 +1,49 @@
+/*  =========================================================================
+    snapshotStore - Tests of the local store of the saves
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/snapshotStore.h"
+#include <catch2/catch.hpp>
+#include <cstdlib>
+
+using namespace srr;
+
+TEST_CASE("Snapshots stored within the same second are listed in creation order")
+{
+    char rootDir[] = "/tmp/srr-snapshots-XXXXXX";
+    REQUIRE(mkdtemp(rootDir) != nullptr);
+
+    SnapshotStore store(std::string(rootDir) + "/store", 10);
+
+    std::vector<std::string> ids;
+    for (int i = 0; i < 5; i++) {
+        SrrSaveResponse save;
+        save.m_version = std::to_string(i);
+        ids.push_back(store.store(save).m_id);
+    }
+
+    std::vector<std::string> listed;
+    for (const auto& manifest : store.list()) {
+        listed.push_back(manifest.m_id);
+    }
+    CHECK(listed == ids);
+
+    std::system((std::string("rm -rf ") + rootDir).c_str());
+}
@@ -0,0 +1,49 @@
+/*  =========================================================================
+    trace - Tests of the trace events collector
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "helpers/trace.h"
+#include <catch2/catch.hpp>
+#include <thread>
+
+using namespace srr;
+
+TEST_CASE("Events of the threads which exited are kept")
+{
+    Tracer::instance().setEnabled(true);
+    const int64_t start = Tracer::nowUs();
+
+    // one thread per request, as the UI requests
+    for (int i = 0; i < 10; i++) {
+        std::thread thread([i]() {
+            TraceSpan span("operation", "request");
+            span.tag("index", std::to_string(i));
+        });
+        thread.join();
+    }
+
+    const std::vector<TraceEvent> events = Tracer::instance().collect(start);
+    CHECK(events.size() == 10);
+
+    // the events are not collected twice
+    CHECK(Tracer::instance().collect(start).size() == 10);
+
+    Tracer::instance().setEnabled(false);
+}
@@ -0,0 +1,316 @@
+/*  =========================================================================
+    worker - Tests of the srr procedures against simulated agents
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#include "dto/request.h"
+#include "dto/response.h"
+#include "fty-srr.h"
+#include "fty_srr_groups.h"
+#include "fty_srr_manager.h"
+#include "helpers/clock.h"
+#include "simulated_agent.h"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <fty_common_dto.h>
+#include <fty_common_messagebus.h>
+#include <malamute.h>
+#include <memory>
+#include <pack/serialization.h>
+
+#define TEST_CLIENT_NAME  "fty-srr-test"
+#define TEST_TIMEOUT_SEC  60
+#define TEST_SETTLE_DELAY 6000 // FEATURE_RESTORE_DELAY_SEC of the worker, in msec
+
+using namespace srr::bench;
+
+namespace {
+
+/**
+ * Broker, one simulated agent per srr queue and a srr manager, the fixed delays being simulated
+ */
+class SrrFixture
+{
+public:
+    SrrFixture(const std::string& endpoint, const std::string& preflight)
+    {
+        m_broker = zactor_new(mlm_server, const_cast<char*>("Malamute"));
+        zstr_sendx(m_broker, "BIND", endpoint.c_str(), nullptr);
+
+        for (const auto& agent : srr::g_agentToQueue) {
+            m_agents[agent.first] =
+                std::make_unique<SimulatedAgent>(endpoint, agent.first, agent.second, AgentBehaviour(), m_counters);
+        }
+        m_licensing = std::make_unique<SimulatedLicensing>(endpoint);
+
+        std::map<std::string, std::string> parameters;
+        parameters[AGENT_NAME_KEY]         = AGENT_NAME;
+        parameters[ENDPOINT_KEY]           = endpoint;
+        parameters[SRR_QUEUE_NAME_KEY]     = SRR_MSG_QUEUE_NAME;
+        parameters[SRR_VERSION_KEY]        = ACTIVE_VERSION;
+        parameters[REQUEST_TIMEOUT_KEY]    = "5000";
+        parameters[ENABLE_REBOOT_KEY]      = "false";
+        parameters[LICENSE_CACHE_TTL_KEY]  = LICENSE_CACHE_TTL_DEFAULT;
+        parameters[BUS_POOL_SIZE_KEY]      = BUS_POOL_SIZE_DEFAULT;
+        parameters[SAVE_TIMEOUT_KEY]       = "5";
+        parameters[PREFLIGHT_KEY]          = preflight;
+        parameters[PREFLIGHT_TIMEOUT_KEY]  = PREFLIGHT_TIMEOUT_DEFAULT;
+        parameters[TRACE_KEY]              = TRACE_DEFAULT;
+        parameters[TRACE_DIR_KEY]          = TRACE_DIR_DEFAULT;
+        parameters[METRICS_FILE_KEY]       = METRICS_FILE_DEFAULT;
+        parameters[METRICS_PERIOD_KEY]     = METRICS_PERIOD_DEFAULT;
+        parameters[SNAPSHOT_DIR_KEY]       = SNAPSHOT_DIR_DEFAULT;
+        parameters[SNAPSHOT_RETENTION_KEY] = SNAPSHOT_RETENTION_DEFAULT;
+        parameters[SAVE_CACHE_STREAM_KEY]  = SAVE_CACHE_STREAM_DEFAULT;
+        parameters[SAVE_CACHE_TTL_KEY]     = SAVE_CACHE_TTL_DEFAULT;
+
+        m_manager = std::make_unique<srr::SrrManager>(parameters, m_clock);
+
+        m_client = std::unique_ptr<messagebus::MessageBus>(messagebus::MlmMessageBus(endpoint, TEST_CLIENT_NAME));
+        m_client->connect();
+    }
+
+    ~SrrFixture()
+    {
+        m_client.reset();
+        m_manager.reset();
+        m_licensing.reset();
+        m_agents.clear();
+        zactor_destroy(&m_broker);
+    }
+
+    void setBehaviour(const std::string& agentName, const AgentBehaviour& behaviour)
+    {
+        m_agents.at(agentName)->setBehaviour(behaviour);
+    }
+
+    // save all the groups, return the payload
+    std::string save()
+    {
+        std::vector<std::string> groupList;
+        for (const auto& group : srr::g_srrGroupMap) {
+            groupList.push_back(group.first);
+        }
+
+        srr::SrrSaveRequest req;
+        req.m_passphrase.setValue(m_passphrase);
+        req.m_group_list.setValue(groupList);
+
+        auto reqJson = pack::json::serialize(req, pack::Option::WithDefaults);
+        REQUIRE(reqJson);
+
+        dto::UserData resp = sendUiRequest("save", {*reqJson});
+        REQUIRE(resp.front() == dto::srr::statusToString(dto::srr::Status::SUCCESS));
+        return resp.back();
+    }
+
+    srr::SrrRestoreResponse restore(const std::string& payload)
+    {
+        srr::SrrSaveResponse        saveResp;
+        cxxtools::SerializationInfo saveSi = dto::srr::deserializeJson(payload);
+        saveSi >>= saveResp;
+
+        auto data    = std::make_shared<srr::SrrRestoreRequestDataV2>();
+        data->m_data = saveResp.m_data;
+
+        srr::SrrRestoreRequest req;
+        req.m_version    = saveResp.m_version;
+        req.m_passphrase = m_passphrase;
+        req.m_checksum   = saveResp.m_checksum;
+        req.m_data_ptr   = data;
+
+        cxxtools::SerializationInfo reqSi;
+        reqSi <<= req;
+
+        dto::UserData resp = sendUiRequest("restore", {dto::srr::serializeJson(reqSi, false)});
+
+        srr::SrrRestoreResponse     restoreResp;
+        cxxtools::SerializationInfo respSi = dto::srr::deserializeJson(resp.back());
+        respSi >>= restoreResp;
+        return restoreResp;
+    }
+
+    srr::SrrResetResponse reset(const std::vector<std::string>& groupList)
+    {
+        srr::SrrResetRequest req;
+        req.m_passphrase.setValue(m_passphrase);
+        req.m_group_list.setValue(groupList);
+
+        auto reqJson = pack::json::serialize(req, pack::Option::WithDefaults);
+        REQUIRE(reqJson);
+
+        dto::UserData resp = sendUiRequest("reset", {*reqJson});
+
+        srr::SrrResetResponse       resetResp;
+        cxxtools::SerializationInfo respSi = dto::srr::deserializeJson(resp.back());
+        respSi >>= resetResp;
+        return resetResp;
+    }
+
+    BusCounters& counters()
+    {
+        return m_counters;
+    }
+
+    srr::SimulatedClock& clock()
+    {
+        return m_clock;
+    }
+
+private:
+    const std::string                                      m_passphrase = "Test-passphrase-2020";
+    zactor_t*                                              m_broker     = nullptr;
+    BusCounters                                            m_counters;
+    std::map<std::string, std::unique_ptr<SimulatedAgent>> m_agents;
+    std::unique_ptr<SimulatedLicensing>                    m_licensing;
+    srr::SimulatedClock                                    m_clock;
+    std::unique_ptr<srr::SrrManager>                       m_manager;
+    std::unique_ptr<messagebus::MessageBus>                m_client;
+
+    dto::UserData sendUiRequest(const std::string& action, const dto::UserData& userData)
+    {
+        messagebus::Message msg;
+        msg.userData() = userData;
+        msg.metaData().emplace(messagebus::Message::SUBJECT, action);
+        msg.metaData().emplace(messagebus::Message::FROM, TEST_CLIENT_NAME);
+        msg.metaData().emplace(messagebus::Message::TO, std::string(AGENT_NAME) + "-ui");
+        msg.metaData().emplace(messagebus::Message::CORRELATION_ID, messagebus::generateUuid());
+
+        return m_client->request(std::string(SRR_MSG_QUEUE_NAME) + ".UI", msg, TEST_TIMEOUT_SEC).userData();
+    }
+};
+
+const srr::Timings& featureTimings(
+    const srr::SrrRestoreResponse& resp, const std::string& groupId, const std::string& featureName)
+{
+    auto group = std::find_if(resp.m_timings.begin(), resp.m_timings.end(), [&](const srr::Timings& timings) {
+        return timings.m_name == groupId;
+    });
+    REQUIRE(group != resp.m_timings.end());
+    auto feature = std::find_if(group->m_features.begin(), group->m_features.end(),
+        [&](const srr::Timings& timings) {
+            return timings.m_name == featureName;
+        });
+    REQUIRE(feature != group->m_features.end());
+    return *feature;
+}
+
+// the alert agent only takes part in the assets group (the errors are translatable, without their arguments)
+void checkOnlyAssetsFailed(const srr::SrrRestoreResponse& resp, const std::string& error)
+{
+    CHECK(resp.m_status == dto::srr::statusToString(dto::srr::Status::PARTIAL_SUCCESS));
+    for (const auto& status : resp.m_status_list) {
+        if (status.m_name == G_ASSETS) {
+            CHECK(status.m_status == dto::srr::statusToString(dto::srr::Status::FAILED));
+            CHECK_THAT(status.m_error, Catch::Contains(error));
+        } else {
+            CHECK(status.m_status == dto::srr::statusToString(dto::srr::Status::SUCCESS));
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("Restore excludes the groups of an unresponsive agent")
+{
+    SrrFixture        srr("ipc://@/fty-srr-test-exclude", "exclude");
+    const std::string payload = srr.save();
+
+    AgentBehaviour silent;
+    silent.m_silent = true;
+    srr.setBehaviour(ALERT_AGENT_NAME, silent);
+
+    checkOnlyAssetsFailed(srr.restore(payload), "agents not responding");
+
+    // the pings do not ask the agents for all their features
+    CHECK(srr.counters().m_fullSaves == 0);
+}
+
+TEST_CASE("Restore is refused when an agent is unresponsive")
+{
+    SrrFixture        srr("ipc://@/fty-srr-test-refuse", "refuse");
+    const std::string payload = srr.save();
+
+    AgentBehaviour silent;
+    silent.m_silent = true;
+    srr.setBehaviour(ALERT_AGENT_NAME, silent);
+
+    const srr::SrrRestoreResponse resp = srr.restore(payload);
+    CHECK(resp.m_status == dto::srr::statusToString(dto::srr::Status::FAILED));
+    CHECK_THAT(resp.m_error, Catch::Contains(ALERT_AGENT_NAME));
+}
+
+TEST_CASE("Restore skips a group whose backup failed")
+{
+    SrrFixture        srr("ipc://@/fty-srr-test-backup", "exclude");
+    const std::string payload = srr.save();
+
+    AgentBehaviour failingSave;
+    failingSave.m_failing = {"save"};
+    srr.setBehaviour(ALERT_AGENT_NAME, failingSave);
+
+    const srr::SrrRestoreResponse resp = srr.restore(payload);
+    checkOnlyAssetsFailed(resp, "Could not backup feature");
+
+    // neither reset nor restored
+    CHECK(std::none_of(resp.m_timings.begin(), resp.m_timings.end(), [](const srr::Timings& timings) {
+        return timings.m_name == G_ASSETS;
+    }));
+}
+
+TEST_CASE("Rollback of a group waits for the settle delay")
+{
+    SrrFixture        srr("ipc://@/fty-srr-test-rollback", "exclude");
+    const std::string payload = srr.save();
+
+    AgentBehaviour failingRestore;
+    failingRestore.m_failing = {"restore"};
+    srr.setBehaviour(ALERT_AGENT_NAME, failingRestore);
+
+    const srr::SrrRestoreResponse resp = srr.restore(payload);
+    checkOnlyAssetsFailed(resp, "Restore failed for feature");
+
+    // the failed feature only settles during the rollback, the features restored before it settle twice
+    CHECK(featureTimings(resp, G_ASSETS, F_ALERT_AGENT).m_settle_ms >= TEST_SETTLE_DELAY);
+    CHECK(featureTimings(resp, G_ASSETS, F_SECURITY_WALLET).m_settle_ms >= 2 * TEST_SETTLE_DELAY);
+}
+
+TEST_CASE("Each restore accounts for its own settle delays")
+{
+    SrrFixture        srr("ipc://@/fty-srr-test-sequential", "exclude");
+    const std::string payload = srr.save();
+
+    // each request runs on a new thread, which must not start back from the time of the first one
+    for (int i = 0; i < 2; i++) {
+        const auto                    before = srr.clock().elapsed();
+        const srr::SrrRestoreResponse resp   = srr.restore(payload);
+        CHECK(resp.m_status == dto::srr::statusToString(dto::srr::Status::SUCCESS));
+        CHECK(srr.clock().elapsed() - before >= std::chrono::milliseconds(TEST_SETTLE_DELAY));
+    }
+}
+
+TEST_CASE("Reset of a group listed twice resets it once")
+{
+    SrrFixture srr("ipc://@/fty-srr-test-reset", "exclude");
+
+    const srr::SrrResetResponse resp = srr.reset({G_ASSETS, G_ASSETS});
+    CHECK(resp.m_status == dto::srr::statusToString(dto::srr::Status::SUCCESS));
+    CHECK(resp.m_status_list.size() == 1);
+    CHECK(resp.m_timings.size() == 1);
+}